@@ -7,6 +7,7 @@
 #include "unity.h"
 #include "utest.h"
 #include <stdio.h>
+#include <utility>
 
 #include "HeapBlockDevice.h"
 #include "LittleFileSystem.h"
@@ -188,6 +189,143 @@ void test_read_str_1()
     TEST_ASSERT_EQUAL(0, errno);
 }
 
+struct ChunkContext {
+    uint8_t data[64];
+    size_t len;
+    int chunks;
+    int stop_after;
+    bool offset_error;
+};
+
+static int collect_chunk(const uint8_t *data, size_t len, off_t offset, void *context)
+{
+    ChunkContext *ctx = (ChunkContext *)context;
+    if ((size_t)offset != ctx->len) {
+        ctx->offset_error = true;
+    }
+    memcpy(ctx->data + ctx->len, data, len);
+    ctx->len += len;
+    ctx->chunks++;
+    return ctx->chunks == ctx->stop_after ? 1 : 0;
+}
+
+void test_read_chunks_1()
+{
+    char file_path[64];
+    join_paths(file_path, BASE_DIR, "test.bin");
+
+    // write test data
+    uint8_t data[40];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)i;
+    }
+    TEST_ASSERT_EQUAL(0, write_data(file_path, data, sizeof(data)));
+
+    // the whole file
+    uint8_t buf[16];
+    ChunkContext ctx = {{0}, 0, 0, 0, false};
+    TEST_ASSERT_EQUAL(0, read_chunks(file_path, buf, sizeof(buf), collect_chunk, &ctx));
+    TEST_ASSERT_EQUAL(3, ctx.chunks);
+    TEST_ASSERT_FALSE(ctx.offset_error);
+    TEST_ASSERT_EQUAL(sizeof(data), ctx.len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, ctx.data, sizeof(data));
+    TEST_ASSERT_EQUAL(0, errno);
+
+    // window
+    memset(&ctx, 0, sizeof(ctx));
+    TEST_ASSERT_EQUAL(0, read_chunks(file_path, buf, sizeof(buf), collect_chunk, &ctx, 10, 20));
+    TEST_ASSERT_EQUAL(2, ctx.chunks);
+    TEST_ASSERT_FALSE(ctx.offset_error);
+    TEST_ASSERT_EQUAL(20, ctx.len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data + 10, ctx.data, 20);
+
+    // window is limited by the file size
+    memset(&ctx, 0, sizeof(ctx));
+    TEST_ASSERT_EQUAL(0, read_chunks(file_path, buf, sizeof(buf), collect_chunk, &ctx, 36, 100));
+    TEST_ASSERT_EQUAL(4, ctx.len);
+    memset(&ctx, 0, sizeof(ctx));
+    TEST_ASSERT_EQUAL(0, read_chunks(file_path, buf, sizeof(buf), collect_chunk, &ctx, 100));
+    TEST_ASSERT_EQUAL(0, ctx.chunks);
+
+    // callback stops reading
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.stop_after = 1;
+    TEST_ASSERT_EQUAL(1, read_chunks(file_path, buf, sizeof(buf), collect_chunk, &ctx));
+    TEST_ASSERT_EQUAL(16, ctx.len);
+
+    join_paths(file_path, BASE_DIR, "missing.bin");
+    TEST_ASSERT_EQUAL(-1, read_chunks(file_path, buf, sizeof(buf), collect_chunk, &ctx));
+    TEST_ASSERT_EQUAL(ENOENT, errno);
+    errno = 0;
+}
+
+void test_file_reader_1()
+{
+    char file_path[64];
+    join_paths(file_path, BASE_DIR, "test.bin");
+    TEST_ASSERT_EQUAL(0, write_str(file_path, "hello world"));
+
+    FileReader reader;
+    uint8_t buf[8];
+    TEST_ASSERT_FALSE(reader.is_open());
+    TEST_ASSERT_EQUAL(0, reader.open(file_path, 6));
+    TEST_ASSERT_TRUE(reader.is_open());
+    TEST_ASSERT_EQUAL(5, reader.size());
+    TEST_ASSERT_EQUAL(3, reader.read(buf, 3));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("wor", buf, 3);
+    TEST_ASSERT_EQUAL(3, reader.position());
+    TEST_ASSERT_EQUAL(2, reader.read(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("ld", buf, 2);
+    TEST_ASSERT_EQUAL(0, reader.read(buf, sizeof(buf)));
+
+    // reopening with length limit
+    TEST_ASSERT_EQUAL(0, reader.open(file_path, 0, 5));
+    TEST_ASSERT_EQUAL(5, reader.read(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("hello", buf, 5);
+    TEST_ASSERT_EQUAL(0, reader.read(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(0, reader.close());
+    TEST_ASSERT_EQUAL(0, errno);
+
+    // closed reader
+    TEST_ASSERT_EQUAL(-1, reader.read(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(EBADF, errno);
+    errno = 0;
+}
+
+void test_map_file_1()
+{
+    char file_path[64];
+    join_paths(file_path, BASE_DIR, "test.bin");
+    TEST_ASSERT_EQUAL(0, write_str(file_path, "hello world"));
+
+    MappedFile file = map_file(file_path, MAP_ACCESS_SEQUENTIAL);
+    TEST_ASSERT_TRUE(file.is_open());
+    TEST_ASSERT_EQUAL(11, file.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("hello world", file.data(), 11);
+    TEST_ASSERT_EQUAL(0, errno);
+
+    // data is moved with the ownership
+    MappedFile other_file;
+    other_file = std::move(file);
+    TEST_ASSERT_FALSE(file.is_open());
+    TEST_ASSERT_TRUE(other_file.is_open());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY("hello world", other_file.data(), 11);
+    TEST_ASSERT_EQUAL(0, other_file.close());
+    TEST_ASSERT_FALSE(other_file.is_open());
+
+    // empty file
+    TEST_ASSERT_EQUAL(0, write_str(file_path, ""));
+    TEST_ASSERT_EQUAL(0, file.open(file_path, MAP_ACCESS_RANDOM));
+    TEST_ASSERT_TRUE(file.is_open());
+    TEST_ASSERT_EQUAL(0, file.size());
+
+    join_paths(file_path, BASE_DIR, "missing.bin");
+    file = map_file(file_path);
+    TEST_ASSERT_FALSE(file.is_open());
+    TEST_ASSERT_EQUAL(ENOENT, errno);
+    errno = 0;
+}
+
 //--------------------------------------------------------------------------------
 // Test helper function create/delete folders
 //--------------------------------------------------------------------------------
@@ -218,6 +356,226 @@ void test_makedirs_1()
     TEST_ASSERT_EQUAL(0, errno);
 }
 
+void test_makedirs_2()
+{
+    int ret_code;
+    char dir_path[64];
+
+    // create directory, whose parent partially exists
+    join_paths(dir_path, BASE_DIR, "abc");
+    ret_code = makedirs(dir_path);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    join_paths(dir_path, BASE_DIR, "abc/some_dir/../other_dir//test/");
+    ret_code = makedirs(dir_path);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(0, errno);
+    join_paths(dir_path, BASE_DIR, "abc/other_dir/test");
+    TEST_ASSERT_EQUAL(true, isdir(dir_path));
+    join_paths(dir_path, BASE_DIR, "abc/some_dir");
+    TEST_ASSERT_EQUAL(false, exists(dir_path));
+
+    // try to create directory inside a file
+    join_paths(dir_path, BASE_DIR, "abc/file.txt");
+    write_str(dir_path, "test content");
+    join_paths(dir_path, BASE_DIR, "abc/file.txt/test");
+    ret_code = makedirs(dir_path, 0777, true);
+    TEST_ASSERT_NOT_EQUAL(0, ret_code);
+    TEST_ASSERT_NOT_EQUAL(0, errno);
+    errno = 0;
+}
+
+void test_makedirs_3()
+{
+    int ret_code;
+    char dir_path[64];
+    MakedirsStats stats;
+
+    // create directory, whose parent exists, with single mkdir call
+    join_paths(dir_path, BASE_DIR, "abc/def");
+    ret_code = makedirs(dir_path);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    join_paths(dir_path, BASE_DIR, "abc/def/ghi");
+    ret_code = makedirs(dir_path, 0777, false, NULL, 0, MAKEDIRS_MKDIR_FIRST, &stats);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(0, errno);
+    TEST_ASSERT_EQUAL(true, isdir(dir_path));
+    TEST_ASSERT_EQUAL(0, stats.stat_calls);
+    TEST_ASSERT_EQUAL(1, stats.mkdir_calls);
+
+    // create several missing directories
+    join_paths(dir_path, BASE_DIR, "abc/x/y/z");
+    ret_code = makedirs(dir_path, 0777, false, NULL, 0, MAKEDIRS_MKDIR_FIRST, &stats);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(0, errno);
+    TEST_ASSERT_EQUAL(true, isdir(dir_path));
+    TEST_ASSERT_EQUAL(0, stats.stat_calls);
+    TEST_ASSERT_EQUAL(5, stats.mkdir_calls);
+
+    // existing directory
+    ret_code = makedirs(dir_path, 0777, false, NULL, 0, MAKEDIRS_MKDIR_FIRST, &stats);
+    TEST_ASSERT_NOT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(EEXIST, errno);
+    errno = 0;
+    ret_code = makedirs(dir_path, 0777, true, NULL, 0, MAKEDIRS_MKDIR_FIRST, &stats);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(1, stats.stat_calls);
+    TEST_ASSERT_EQUAL(1, stats.mkdir_calls);
+
+    // compare with stat based strategy
+    ret_code = makedirs(dir_path, 0777, true, NULL, 0, MAKEDIRS_STAT_FIRST, &stats);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(1, stats.stat_calls);
+    TEST_ASSERT_EQUAL(0, stats.mkdir_calls);
+
+    // leaf is a file
+    join_paths(dir_path, BASE_DIR, "abc/file.txt");
+    write_str(dir_path, "test content");
+    ret_code = makedirs(dir_path, 0777, true, NULL, 0, MAKEDIRS_MKDIR_FIRST);
+    TEST_ASSERT_NOT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(EEXIST, errno);
+    errno = 0;
+
+    // parent is a file
+    join_paths(dir_path, BASE_DIR, "abc/file.txt/test");
+    ret_code = makedirs(dir_path, 0777, true, NULL, 0, MAKEDIRS_MKDIR_FIRST);
+    TEST_ASSERT_NOT_EQUAL(0, ret_code);
+    TEST_ASSERT_NOT_EQUAL(0, errno);
+    errno = 0;
+}
+
+void test_makedirs_batch_1()
+{
+    int ret_code;
+    char dir_path[64];
+    char file_path[64];
+    int errors[7];
+    MakedirsStats stats;
+    const char *paths[] = {
+        "/test_bd/abc/logs",
+        "/test_bd/abc/data/../cfg",
+        "/test_bd/abc/data",
+        "/test_bd/abc/data/",
+        "/test_bd/abc-def",
+        "/test_bd/abc/file.txt/test",
+        "/test_bd/abc/data/x/y",
+    };
+    const size_t paths_num = sizeof(paths) / sizeof(paths[0]);
+
+    join_paths(dir_path, BASE_DIR, "abc");
+    ret_code = makedirs(dir_path);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    join_paths(file_path, BASE_DIR, "abc/file.txt");
+    write_str(file_path, "test content");
+
+    ret_code = makedirs_batch(paths, paths_num, 0777, errors, NULL, 0, &stats);
+    TEST_ASSERT_NOT_EQUAL(0, ret_code);
+    TEST_ASSERT_NOT_EQUAL(0, errno);
+    errno = 0;
+    TEST_ASSERT_EQUAL(0, errors[0]);
+    TEST_ASSERT_EQUAL(0, errors[1]);
+    TEST_ASSERT_EQUAL(0, errors[2]);
+    TEST_ASSERT_EQUAL(0, errors[3]);
+    TEST_ASSERT_EQUAL(0, errors[4]);
+    TEST_ASSERT_NOT_EQUAL(0, errors[5]);
+    TEST_ASSERT_EQUAL(0, errors[6]);
+    // each distinct directory is checked only once
+    TEST_ASSERT_EQUAL(6, stats.stat_calls);
+    TEST_ASSERT_EQUAL(9, stats.mkdir_calls);
+
+    join_paths(dir_path, BASE_DIR, "abc/logs");
+    TEST_ASSERT_EQUAL(true, isdir(dir_path));
+    join_paths(dir_path, BASE_DIR, "abc/cfg");
+    TEST_ASSERT_EQUAL(true, isdir(dir_path));
+    join_paths(dir_path, BASE_DIR, "abc-def");
+    TEST_ASSERT_EQUAL(true, isdir(dir_path));
+    join_paths(dir_path, BASE_DIR, "abc/data/x/y");
+    TEST_ASSERT_EQUAL(true, isdir(dir_path));
+    TEST_ASSERT_EQUAL(true, isfile(file_path));
+
+    // all directories exist
+    ret_code = makedirs_batch(paths, paths_num - 3, 0777, errors);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(0, errno);
+
+    // insufficient buffer
+    ret_code = makedirs_batch(paths, paths_num, 0777, errors, dir_path, sizeof(dir_path));
+    TEST_ASSERT_NOT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    errno = 0;
+}
+
+void test_stat_cache_1()
+{
+    int ret_code;
+    char dir_path[64];
+    char file_path[64];
+    StatCacheStats stats;
+    uint32_t start_time;
+
+    ret_code = stat_cache_enable(16);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    join_paths(dir_path, BASE_DIR, "abc");
+    join_paths(file_path, BASE_DIR, "abc/file.txt");
+
+    // cache negative result
+    TEST_ASSERT_EQUAL(false, exists(dir_path));
+    TEST_ASSERT_EQUAL(false, isdir(dir_path));
+    stat_cache_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.hits);
+    TEST_ASSERT_EQUAL(1, stats.misses);
+
+    // makedirs invalidates cache
+    ret_code = makedirs(dir_path);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    stat_cache_get_stats(&stats, true);
+    TEST_ASSERT_EQUAL(true, isdir(dir_path));
+    TEST_ASSERT_EQUAL(true, isdir("/test_bd//abc/"));
+    stat_cache_get_stats(&stats, true);
+    TEST_ASSERT_EQUAL(1, stats.hits);
+    TEST_ASSERT_EQUAL(1, stats.misses);
+
+    // write_data invalidates file and its parent
+    TEST_ASSERT_EQUAL(-1, getsize(file_path));
+    errno = 0;
+    write_str(file_path, "12345");
+    TEST_ASSERT_EQUAL(5, getsize(file_path));
+    TEST_ASSERT_EQUAL(true, isfile(file_path));
+    TEST_ASSERT_EQUAL(true, isdir(dir_path));
+    stat_cache_get_stats(&stats, true);
+    TEST_ASSERT_EQUAL(1, stats.hits);
+    TEST_ASSERT_EQUAL(3, stats.misses);
+
+    // rmtree invalidates tree content
+    ret_code = rmtree(dir_path);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(false, exists(file_path));
+    TEST_ASSERT_EQUAL(false, exists(dir_path));
+    TEST_ASSERT_EQUAL(0, errno);
+
+    // explicit invalidation
+    stat_cache_get_stats(&stats, true);
+    TEST_ASSERT_EQUAL(false, exists(dir_path));
+    stat_cache_invalidate(BASE_DIR);
+    TEST_ASSERT_EQUAL(false, exists(dir_path));
+    stat_cache_get_stats(&stats, true);
+    TEST_ASSERT_EQUAL(1, stats.hits);
+    TEST_ASSERT_EQUAL(1, stats.misses);
+
+    // entries expiration
+    ret_code = stat_cache_enable(16, 1);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(false, exists(dir_path));
+    start_time = us_ticker_read();
+    while (us_ticker_read() - start_time < 2000) {
+    }
+    TEST_ASSERT_EQUAL(false, exists(dir_path));
+    stat_cache_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.hits);
+    TEST_ASSERT_EQUAL(2, stats.misses);
+
+    stat_cache_disable();
+}
+
 void test_rmtree_1()
 {
     char path[128];
@@ -335,6 +693,65 @@ void test_rmtree_4()
     TEST_ASSERT_EQUAL(false, exists(test_dir_path));
 }
 
+static int create_deep_tree(const char *base_dir, int depth)
+{
+    char path_buf[128];
+    char name_buf[32];
+
+    strcpy(path_buf, base_dir);
+    VERIFY_SUCCESS(makedirs(path_buf));
+    for (int i = 0; i < depth; i++) {
+        sprintf(name_buf, "file_%i", i);
+        append_path(path_buf, name_buf);
+        VERIFY_SUCCESS_OR_LENGTH(write_str(path_buf, "test content"));
+        dirname(path_buf);
+        sprintf(name_buf, "dir_%i", i);
+        append_path(path_buf, name_buf);
+        VERIFY_SUCCESS(mkdir(path_buf, 0777));
+    }
+
+    return 0;
+}
+
+void test_rmtree_5()
+{
+    char path[128];
+    join_paths(path, BASE_DIR, "test/test_dir");
+
+    // remove deep tree using only one opened directory at the moment
+    create_deep_tree(path, 6);
+    TEST_ASSERT_EQUAL(0, errno);
+    TEST_ASSERT_EQUAL(true, exists(path));
+    int ret_code = rmtree(path, NULL, 0, 1);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(0, errno);
+    TEST_ASSERT_EQUAL(false, exists(path));
+
+    // remove deep tree using two opened directories at the moment
+    create_deep_tree(path, 6);
+    TEST_ASSERT_EQUAL(0, errno);
+    ret_code = rmtree(path, NULL, 0, 2);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(0, errno);
+    TEST_ASSERT_EQUAL(false, exists(path));
+}
+
+void test_rmtree_6()
+{
+    char path[128];
+    char buff[32];
+    join_paths(path, BASE_DIR, "test/test_dir");
+    create_deep_tree(path, 4);
+    TEST_ASSERT_EQUAL(0, errno);
+
+    // buffer is too small for the deepest entries
+    int ret_code = rmtree(path, buff, sizeof(buff));
+    TEST_ASSERT_NOT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    errno = 0;
+    TEST_ASSERT_EQUAL(true, exists(path));
+}
+
 int count_dir_entities(const char *path)
 {
     struct dirent *dir_entity;
@@ -409,6 +826,290 @@ void test_cleartree_3()
     TEST_ASSERT_NOT_EQUAL(0, ret_code);
     TEST_ASSERT_NOT_EQUAL(0, errno);
 }
+
+void test_cleartree_4()
+{
+    char path[128];
+    join_paths(path, BASE_DIR, "test/test_dir");
+    create_deep_tree(path, 6);
+    TEST_ASSERT_EQUAL(0, errno);
+
+    int ret_code = cleartree(path, NULL, 0, 1);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(0, errno);
+    TEST_ASSERT_EQUAL(true, exists(path));
+    TEST_ASSERT_EQUAL(0, count_dir_entities(path));
+}
+void test_tree_remover_1()
+{
+    char path[128];
+    join_paths(path, BASE_DIR, "test/test_dir");
+    create_deep_tree(path, 4);
+    TEST_ASSERT_EQUAL(0, errno);
+
+    // remove tree by one entry
+    TreeRemover remover;
+    int ret_code = remover.start(path, true, true);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(true, remover.is_running());
+    size_t steps = 0;
+    while ((ret_code = remover.step(1)) > 0) {
+        steps++;
+        TEST_ASSERT_EQUAL(steps, remover.entries_removed());
+    }
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(0, errno);
+    TEST_ASSERT_EQUAL(true, remover.is_done());
+    // 4 files, 4 subdirectories and root directory
+    TEST_ASSERT_EQUAL(9, remover.entries_removed());
+    TEST_ASSERT_EQUAL(4 * strlen("test content"), remover.bytes_freed());
+    TEST_ASSERT_EQUAL(false, exists(path));
+}
+
+void test_tree_remover_2()
+{
+    char path[128];
+    join_paths(path, BASE_DIR, "test/test_dir");
+    create_deep_tree(path, 4);
+    TEST_ASSERT_EQUAL(0, errno);
+
+    // clear tree with time budget
+    TreeRemover remover(1);
+    int ret_code = remover.start(path, false);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    while ((ret_code = remover.step(0, 1000)) > 0) {
+    }
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(0, errno);
+    TEST_ASSERT_EQUAL(8, remover.entries_removed());
+    TEST_ASSERT_EQUAL(true, exists(path));
+    TEST_ASSERT_EQUAL(0, count_dir_entities(path));
+}
+
+void test_tree_remover_3()
+{
+    char path[128];
+    join_paths(path, BASE_DIR, "test/test_dir");
+    create_deep_tree(path, 4);
+    TEST_ASSERT_EQUAL(0, errno);
+
+    // cancel removal
+    TreeRemover remover;
+    int ret_code = remover.start(path);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    ret_code = remover.step(2);
+    TEST_ASSERT_EQUAL(1, ret_code);
+    TEST_ASSERT_EQUAL(2, remover.entries_removed());
+    ret_code = remover.cancel();
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(false, remover.is_running());
+    TEST_ASSERT_EQUAL(true, exists(path));
+    TEST_ASSERT_EQUAL(0, errno);
+
+    // removal can be restarted
+    ret_code = remover.start(path);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    ret_code = remover.step();
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(false, exists(path));
+    TEST_ASSERT_EQUAL(0, errno);
+}
+
+struct WalkTestState {
+    int pre_dirs;
+    int post_dirs;
+    int files;
+    int file_ids_sum;
+    size_t max_depth;
+    const char *skip_name;
+    const char *stop_name;
+};
+
+static int walk_test_callback(const WalkEntry &entry, void *context)
+{
+    WalkTestState *state = (WalkTestState *)context;
+    if (entry.depth > state->max_depth) {
+        state->max_depth = entry.depth;
+    }
+    if (strncmp(entry.path, BASE_DIR, strlen(BASE_DIR)) != 0 || strlen(entry.path) != entry.path_len) {
+        return -1;
+    }
+    switch (entry.event) {
+    case WALK_PRE_DIR:
+        state->pre_dirs++;
+        if (state->skip_name != NULL && strcmp(entry.name, state->skip_name) == 0) {
+            return WALK_SKIP;
+        }
+        break;
+    case WALK_POST_DIR:
+        state->post_dirs++;
+        break;
+    default:
+        state->files++;
+        state->file_ids_sum += atoi(entry.name + strlen("file_"));
+        if (state->stop_name != NULL && strcmp(entry.name, state->stop_name) == 0) {
+            return WALK_STOP;
+        }
+        break;
+    }
+    return WALK_CONTINUE;
+}
+
+void test_walk_1()
+{
+    char path[128];
+    char buff[128];
+    WalkTestState state;
+    join_paths(path, BASE_DIR, "test/test_dir");
+    create_deep_tree(path, 4);
+    TEST_ASSERT_EQUAL(0, errno);
+
+    // full traversal with one opened directory at the moment
+    for (size_t max_open_dirs = 1; max_open_dirs <= 4; max_open_dirs++) {
+        memset(&state, 0, sizeof(state));
+        TEST_ASSERT_EQUAL(0, walk(path, walk_test_callback, &state, buff, sizeof(buff), 0, max_open_dirs));
+        TEST_ASSERT_EQUAL(5, state.pre_dirs);
+        TEST_ASSERT_EQUAL(5, state.post_dirs);
+        TEST_ASSERT_EQUAL(4, state.files);
+        TEST_ASSERT_EQUAL(0 + 1 + 2 + 3, state.file_ids_sum);
+        TEST_ASSERT_EQUAL(4, state.max_depth);
+        TEST_ASSERT_EQUAL(0, errno);
+    }
+
+    // depth limit
+    memset(&state, 0, sizeof(state));
+    TEST_ASSERT_EQUAL(0, walk(path, walk_test_callback, &state, buff, sizeof(buff), 2));
+    TEST_ASSERT_EQUAL(3, state.pre_dirs);
+    TEST_ASSERT_EQUAL(2, state.post_dirs);
+    TEST_ASSERT_EQUAL(2, state.files);
+    TEST_ASSERT_EQUAL(2, state.max_depth);
+
+    // pruning
+    memset(&state, 0, sizeof(state));
+    state.skip_name = "dir_1";
+    TEST_ASSERT_EQUAL(0, walk(path, walk_test_callback, &state, buff, sizeof(buff), 0, 1));
+    TEST_ASSERT_EQUAL(3, state.pre_dirs);
+    TEST_ASSERT_EQUAL(2, state.post_dirs);
+    TEST_ASSERT_EQUAL(0 + 1, state.file_ids_sum);
+
+    // stop
+    memset(&state, 0, sizeof(state));
+    state.stop_name = "file_2";
+    TEST_ASSERT_EQUAL(WALK_STOP, walk(path, walk_test_callback, &state, buff, sizeof(buff)));
+    // "file_2" is inside "dir_1", so "dir_0", "dir_1" and root aren't finished
+    TEST_ASSERT_TRUE(state.post_dirs <= 2);
+
+    // buffer is too small for the deepest entries
+    memset(&state, 0, sizeof(state));
+    TEST_ASSERT_EQUAL(-1, walk(path, walk_test_callback, &state, buff, 48));
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    errno = 0;
+    TEST_ASSERT_EQUAL(true, exists(path));
+}
+
+void test_tree_walker_1()
+{
+    char path[128];
+    char buff[128];
+    WalkEntry entry;
+    TreeWalker walker(2);
+    int ret_code;
+    int files = 0;
+    join_paths(path, BASE_DIR, "test/test_dir");
+    create_deep_tree(path, 4);
+    TEST_ASSERT_EQUAL(0, errno);
+
+    // root directory is reported first and last
+    TEST_ASSERT_EQUAL(0, walker.start(path, buff, sizeof(buff)));
+    TEST_ASSERT_EQUAL(1, walker.next(&entry));
+    TEST_ASSERT_EQUAL(WALK_PRE_DIR, entry.event);
+    TEST_ASSERT_EQUAL(DT_DIR, entry.type);
+    TEST_ASSERT_EQUAL(0, entry.depth);
+    TEST_ASSERT_EQUAL_STRING(path, entry.path);
+    while ((ret_code = walker.next(&entry)) > 0) {
+        if (entry.event == WALK_PRE_DIR) {
+            TEST_ASSERT_EQUAL_STRING("dir_0", entry.name);
+            TEST_ASSERT_EQUAL(1, entry.depth);
+            walker.skip_dir();
+        } else if (entry.event == WALK_FILE) {
+            TEST_ASSERT_EQUAL_STRING("file_0", entry.name);
+            TEST_ASSERT_EQUAL(DT_REG, entry.type);
+            files++;
+        } else {
+            TEST_ASSERT_EQUAL(0, entry.depth);
+            TEST_ASSERT_EQUAL_STRING(path, entry.path);
+        }
+    }
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(1, files);
+    TEST_ASSERT_FALSE(walker.is_running());
+
+    // skip root directory
+    TEST_ASSERT_EQUAL(0, walker.start(path, buff, sizeof(buff)));
+    TEST_ASSERT_EQUAL(1, walker.next(&entry));
+    walker.skip_dir();
+    TEST_ASSERT_EQUAL(0, walker.next(&entry));
+
+    join_paths(path, BASE_DIR, "test/not_exists");
+    TEST_ASSERT_NOT_EQUAL(0, walker.start(path, buff, sizeof(buff)));
+    TEST_ASSERT_EQUAL(ENOENT, errno);
+    errno = 0;
+}
+
+void test_disk_usage_1()
+{
+    char path[128];
+    char buff[128];
+    uint64_t bytes = 0;
+    size_t files = 0;
+    size_t dirs = 0;
+    join_paths(path, BASE_DIR, "test/test_dir");
+    create_deep_tree(path, 4);
+    TEST_ASSERT_EQUAL(0, errno);
+
+    // each level contains a file with "test content" and a subdirectory
+    TEST_ASSERT_EQUAL(0, disk_usage(path, &bytes, &files, &dirs, buff, sizeof(buff), 2));
+    TEST_ASSERT_EQUAL(0, errno);
+    TEST_ASSERT_EQUAL(48, (int)bytes);
+    TEST_ASSERT_EQUAL(4, files);
+    TEST_ASSERT_EQUAL(4, dirs);
+
+    // scanning by single entry steps gives the same result
+    DiskUsageScanner scanner;
+    int steps = 0;
+    int ret_code;
+    TEST_ASSERT_EQUAL(0, scanner.start(path));
+    while ((ret_code = scanner.step(1)) > 0) {
+        steps++;
+    }
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_TRUE(scanner.is_done());
+    TEST_ASSERT_TRUE(steps >= 8);
+    TEST_ASSERT_EQUAL(48, (int)scanner.bytes());
+    TEST_ASSERT_EQUAL(4, scanner.files());
+    TEST_ASSERT_EQUAL(4, scanner.dirs());
+
+#if PATHUTIL_USE_THREADS
+    bytes = 0;
+    TEST_ASSERT_EQUAL(0, disk_usage_parallel(path, &bytes, &files, &dirs, 2));
+    TEST_ASSERT_EQUAL(48, (int)bytes);
+    TEST_ASSERT_EQUAL(4, files);
+    TEST_ASSERT_EQUAL(4, dirs);
+#endif
+
+    // empty directory
+    join_paths(path, BASE_DIR, "test/test_dir/dir_0/dir_1/dir_2/dir_3");
+    TEST_ASSERT_EQUAL(0, disk_usage(path, &bytes, &files, &dirs));
+    TEST_ASSERT_EQUAL(0, (int)bytes);
+    TEST_ASSERT_EQUAL(0, files);
+    TEST_ASSERT_EQUAL(0, dirs);
+
+    join_paths(path, BASE_DIR, "test/not_exists");
+    TEST_ASSERT_EQUAL(-1, disk_usage(path, &bytes));
+    TEST_ASSERT_EQUAL(ENOENT, errno);
+    errno = 0;
+}
+
 //--------------------------------------------------------------------------------
 // Test helper function to check files
 //--------------------------------------------------------------------------------
@@ -497,6 +1198,138 @@ void test_getsize_1()
     TEST_ASSERT_NOT_EQUAL(0, errno);
 }
 
+void test_path_info_1()
+{
+    int ret_code;
+    char file_path[64];
+    char dir_path[64];
+    char nothing_path[64];
+    const char *paths[] = {file_path, dir_path, nothing_path};
+    PathInfo infos[3];
+    PathInfo info;
+
+    join_paths(file_path, BASE_DIR, "some_file.txt");
+    write_data(file_path, (const uint8_t *)"abcd", 4);
+    join_paths(dir_path, BASE_DIR, "some_dir");
+    makedirs(dir_path);
+    join_paths(nothing_path, BASE_DIR, "some_dir/note_exists.d");
+
+    ret_code = path_info(file_path, &info);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(PATH_TYPE_FILE, info.type);
+    TEST_ASSERT_EQUAL(4, info.size);
+    TEST_ASSERT_EQUAL(0, info.error);
+
+    ret_code = path_info(dir_path, &info);
+    TEST_ASSERT_EQUAL(0, ret_code);
+    TEST_ASSERT_EQUAL(PATH_TYPE_DIR, info.type);
+    TEST_ASSERT_EQUAL(0, info.error);
+
+    // errno isn't changed
+    errno = EINTR;
+    ret_code = path_info(nothing_path, &info);
+    TEST_ASSERT_EQUAL(-1, ret_code);
+    TEST_ASSERT_EQUAL(PATH_TYPE_NONE, info.type);
+    TEST_ASSERT_EQUAL(ENOENT, info.error);
+    TEST_ASSERT_EQUAL(EINTR, errno);
+    TEST_ASSERT_EQUAL(false, isfile(nothing_path));
+    TEST_ASSERT_EQUAL(EINTR, errno);
+    errno = 0;
+
+    TEST_ASSERT_EQUAL(2, path_info_batch(paths, 3, infos));
+    TEST_ASSERT_EQUAL(PATH_TYPE_FILE, infos[0].type);
+    TEST_ASSERT_EQUAL(4, infos[0].size);
+    TEST_ASSERT_EQUAL(PATH_TYPE_DIR, infos[1].type);
+    TEST_ASSERT_EQUAL(PATH_TYPE_NONE, infos[2].type);
+    TEST_ASSERT_EQUAL(ENOENT, infos[2].error);
+    TEST_ASSERT_EQUAL(0, errno);
+}
+
+void test_stat_batch_1()
+{
+    ssize_t ret_code;
+    char path[64];
+    char buff[512];
+    PathInfo infos[8];
+    const char *paths[] = {
+        "/test_bd/dir_a/file_2.txt",
+        "/test_bd/dir_a/missing.txt",
+        "/test_bd/dir_a//file_1.txt",
+        "/test_bd/dir_a/sub_dir",
+        "/test_bd/missing_dir/file_1.txt",
+        "/test_bd",
+        "/test_bd/dir_a/../dir_a/file_1.txt",
+        "/test_bd/dir_a",
+    };
+    const size_t paths_num = sizeof(paths) / sizeof(paths[0]);
+
+    join_paths(path, BASE_DIR, "dir_a/sub_dir");
+    makedirs(path);
+    join_paths(path, BASE_DIR, "dir_a/file_1.txt");
+    write_str(path, "1");
+    join_paths(path, BASE_DIR, "dir_a/file_2.txt");
+    write_str(path, "22");
+
+    for (int type_only = 0; type_only < 2; type_only++) {
+        ret_code = stat_batch(paths, paths_num, infos, type_only, buff, sizeof(buff));
+        TEST_ASSERT_EQUAL(6, ret_code);
+        TEST_ASSERT_EQUAL(0, errno);
+        TEST_ASSERT_EQUAL(PATH_TYPE_FILE, infos[0].type);
+        TEST_ASSERT_EQUAL(PATH_TYPE_NONE, infos[1].type);
+        TEST_ASSERT_EQUAL(ENOENT, infos[1].error);
+        TEST_ASSERT_EQUAL(PATH_TYPE_FILE, infos[2].type);
+        TEST_ASSERT_EQUAL(PATH_TYPE_DIR, infos[3].type);
+        TEST_ASSERT_EQUAL(PATH_TYPE_NONE, infos[4].type);
+        TEST_ASSERT_EQUAL(ENOENT, infos[4].error);
+        TEST_ASSERT_EQUAL(PATH_TYPE_DIR, infos[5].type);
+        TEST_ASSERT_EQUAL(PATH_TYPE_FILE, infos[6].type);
+        TEST_ASSERT_EQUAL(PATH_TYPE_DIR, infos[7].type);
+        if (!type_only) {
+            TEST_ASSERT_EQUAL(2, infos[0].size);
+            TEST_ASSERT_EQUAL(1, infos[2].size);
+        }
+    }
+
+    // insufficient buffer
+    ret_code = stat_batch(paths, paths_num, infos, false, buff, 16);
+    TEST_ASSERT_EQUAL(-1, ret_code);
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    errno = 0;
+}
+
+void test_stat_batch_2()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    char path[64];
+    PathInfo infos[2];
+    const char *paths[] = {
+        "/test_bd/search_only/file_1.txt",
+        "/test_bd/search_only/file_2.txt",
+    };
+
+    join_paths(path, BASE_DIR, "search_only");
+    makedirs(path);
+    join_paths(path, BASE_DIR, "search_only/file_1.txt");
+    write_str(path, "1");
+    join_paths(path, BASE_DIR, "search_only/file_2.txt");
+    write_str(path, "22");
+
+    // entries of the directory without read permission are accessible by their paths
+    join_paths(path, BASE_DIR, "search_only");
+    TEST_ASSERT_EQUAL(0, chmod(path, 0311));
+    for (int type_only = 0; type_only < 2; type_only++) {
+        TEST_ASSERT_EQUAL(2, stat_batch(paths, 2, infos, type_only));
+        TEST_ASSERT_EQUAL(0, errno);
+        TEST_ASSERT_EQUAL(PATH_TYPE_FILE, infos[0].type);
+        TEST_ASSERT_EQUAL(PATH_TYPE_FILE, infos[1].type);
+        if (!type_only) {
+            TEST_ASSERT_EQUAL(2, infos[1].size);
+        }
+    }
+    TEST_ASSERT_EQUAL(0, chmod(path, 0755));
+#endif
+}
+
 //--------------------------------------------------------------------------------
 // Test helper function to read directory
 //--------------------------------------------------------------------------------
@@ -559,6 +1392,609 @@ void test_readdir_child_2()
     TEST_ASSERT_EQUAL(0, num_files);
 }
 
+void test_readdir_match_1()
+{
+    char dir_path[64];
+    join_paths(dir_path, BASE_DIR, "test_dir");
+    mkdir(dir_path, 0777);
+
+    char file_path[64];
+    join_paths(file_path, dir_path, "file_1.txt");
+    write_str(file_path, "hello world");
+    join_paths(file_path, dir_path, "file_2.log");
+    write_str(file_path, "hello world");
+    join_paths(file_path, dir_path, "file_3.txt");
+    write_str(file_path, "hello world");
+    join_paths(file_path, dir_path, "file_4.txt");
+    mkdir(file_path, 0777);
+
+    int num_files = 0;
+    DIR *dir_p;
+    struct dirent *dirent_p;
+    GlobPattern pattern;
+    TEST_ASSERT_EQUAL(0, pattern.compile("file_[1-3].txt"));
+
+    if ((dir_p = opendir(dir_path)) == NULL) {
+        TEST_FAIL();
+        return;
+    }
+    while ((dirent_p = readdir_match(dir_p, pattern))) {
+        TEST_ASSERT_TRUE(fnmatch("file_?.txt", dirent_p->d_name));
+        num_files += 1;
+    }
+    if (closedir(dir_p)) {
+        TEST_FAIL();
+        return;
+    }
+
+    TEST_ASSERT_EQUAL(2, num_files);
+}
+
+void test_dir_listing_1()
+{
+    char dir_path[64];
+    join_paths(dir_path, BASE_DIR, "test_dir");
+    mkdir(dir_path, 0777);
+
+    char file_path[64];
+    join_paths(file_path, dir_path, "b.txt");
+    write_str(file_path, "hello");
+    join_paths(file_path, dir_path, "a.txt");
+    write_str(file_path, "hello world");
+    join_paths(file_path, dir_path, "c.log");
+    write_str(file_path, "");
+    join_paths(file_path, dir_path, "d_dir");
+    mkdir(file_path, 0777);
+
+    uint64_t arena_buff[64];
+    PathArena arena(arena_buff, sizeof(arena_buff));
+    DirListing listing;
+
+    // sorting with directories at first
+    TEST_ASSERT_EQUAL(0, scandir(dir_path, listing, arena, DIR_SORT_DIRS_FIRST));
+    TEST_ASSERT_EQUAL(4, listing.size());
+    TEST_ASSERT_EQUAL_STRING("d_dir", listing[0].name());
+    TEST_ASSERT_EQUAL(DT_DIR, listing[0].type);
+    TEST_ASSERT_EQUAL_STRING("a.txt", listing[1].name());
+    TEST_ASSERT_EQUAL(5, listing[1].name_len);
+    TEST_ASSERT_EQUAL_STRING("b.txt", listing[2].name());
+    TEST_ASSERT_EQUAL_STRING("c.log", listing[3].name());
+    TEST_ASSERT_EQUAL(PATH_TYPE_DIR, listing.info(0).type);
+    TEST_ASSERT_EQUAL(PATH_TYPE_FILE, listing.info(1).type);
+    TEST_ASSERT_EQUAL(11, listing.info(1).size);
+    TEST_ASSERT_EQUAL(5, listing.info(2).size);
+    TEST_ASSERT_TRUE(listing[2].info_flag);
+    TEST_ASSERT_EQUAL(0, listing.close());
+    // cached information is available after closing
+    TEST_ASSERT_EQUAL(5, listing.info(2).size);
+    TEST_ASSERT_EQUAL(EBADF, listing.info(3).error);
+
+    // filtering and reusing of the listing
+    GlobPattern pattern;
+    TEST_ASSERT_EQUAL(0, pattern.compile("*.txt"));
+    arena.reset();
+    TEST_ASSERT_EQUAL(0, scandir(dir_path, listing, arena, DIR_SORT_NAME, &pattern));
+    TEST_ASSERT_EQUAL(2, listing.size());
+    TEST_ASSERT_EQUAL_STRING("a.txt", listing[0].name());
+    TEST_ASSERT_EQUAL_STRING("b.txt", listing[1].name());
+    TEST_ASSERT_EQUAL(11, listing.info(0).size);
+
+    // file is deleted after listing
+    join_paths(file_path, dir_path, "b.txt");
+    remove(file_path);
+    TEST_ASSERT_EQUAL(ENOENT, listing.info(1).error);
+    TEST_ASSERT_EQUAL(PATH_TYPE_NONE, listing.info(1).type);
+    TEST_ASSERT_EQUAL(0, listing.close());
+
+    // missing directory
+    join_paths(file_path, dir_path, "missing");
+    TEST_ASSERT_EQUAL(-1, listing.scan(file_path, arena));
+    TEST_ASSERT_EQUAL(ENOENT, errno);
+    TEST_ASSERT_EQUAL(0, listing.size());
+
+    // insufficient arena
+    PathArena small_arena(arena_buff, 32);
+    TEST_ASSERT_EQUAL(-1, listing.scan(dir_path, small_arena));
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    TEST_ASSERT_EQUAL(0, listing.size());
+    errno = 0;
+}
+
+//--------------------------------------------------------------------------------
+// Test path manipulation functions
+//--------------------------------------------------------------------------------
+
+static void check_normpath(const char *path, const char *expected_path)
+{
+    char buf[64];
+    strcpy(buf, path);
+    TEST_ASSERT_EQUAL(strcmp(path, expected_path) == 0, is_normalized(path));
+    normpath(buf);
+    TEST_ASSERT_EQUAL_STRING(expected_path, buf);
+    TEST_ASSERT_EQUAL(true, is_normalized(buf));
+}
+
+void test_normpath_1()
+{
+    check_normpath("/", "/");
+    check_normpath(".", ".");
+    check_normpath("/test_bd/config/device/settings.txt", "/test_bd/config/device/settings.txt");
+    check_normpath("/test_bd/.config/..hidden/file.", "/test_bd/.config/..hidden/file.");
+    check_normpath("/test_bd//config/./device/../device/settings.txt/", "/test_bd/config/device/settings.txt");
+    check_normpath("/test_bd/some/long/path/with/many/components/and/separator/", "/test_bd/some/long/path/with/many/components/and/separator");
+    check_normpath("/test_bd/some/long/path/with/many/components//and/separator", "/test_bd/some/long/path/with/many/components/and/separator");
+    check_normpath("/../test_bd", "/test_bd");
+    check_normpath("abc/..", ".");
+    check_normpath("../../abc", "../../abc");
+    check_normpath("..//abc/./def", "../abc/def");
+    check_normpath("./abc", "abc");
+}
+
+void test_normpath_batch_1()
+{
+    const char *paths[] = {"/test_bd/config/device/settings.txt", "/test_bd//config/./device/../device/settings.txt/", "", "abc/..", "/../test_bd", "../../abc"};
+    const size_t count = sizeof(paths) / sizeof(paths[0]);
+    char buff[160];
+    char path[64];
+    size_t offsets[count];
+    size_t lengths[count];
+    size_t pos = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        offsets[i] = pos;
+        strcpy(buff + pos, paths[i]);
+        pos += strlen(paths[i]) + 1;
+    }
+    TEST_ASSERT_EQUAL(0, normpath_batch(buff, offsets, count, lengths));
+    for (size_t i = 0; i < count; i++) {
+        strcpy(path, paths[i]);
+        normpath(path);
+        TEST_ASSERT_EQUAL_STRING(path, buff + offsets[i]);
+        TEST_ASSERT_EQUAL(strlen(path), lengths[i]);
+    }
+    // lengths are optional
+    TEST_ASSERT_EQUAL(0, normpath_batch(buff, offsets, count));
+    TEST_ASSERT_EQUAL_STRING("/test_bd/config/device/settings.txt", buff + offsets[1]);
+}
+
+void test_path_buffer_1()
+{
+    PathBuffer<16> path;
+
+    TEST_ASSERT_EQUAL(0, path.size());
+    TEST_ASSERT_EQUAL_STRING("", path.c_str());
+    TEST_ASSERT_EQUAL(0, path.assign("/test_bd"));
+    TEST_ASSERT_EQUAL(0, path.append("abc"));
+    TEST_ASSERT_EQUAL_STRING("/test_bd/abc", path.c_str());
+    TEST_ASSERT_EQUAL(12, path.size());
+    TEST_ASSERT_EQUAL_STRING("abc", path.basename());
+
+    // path, that doesn't fit buffer, is rejected without modification
+    TEST_ASSERT_NOT_EQUAL(0, path.append("def"));
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    errno = 0;
+    TEST_ASSERT_EQUAL_STRING("/test_bd/abc", path.c_str());
+    TEST_ASSERT_NOT_EQUAL(0, path.assign("/some/long/path/"));
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    errno = 0;
+    TEST_ASSERT_EQUAL_STRING("/test_bd/abc", path.c_str());
+
+    // scoped traversal
+    {
+        PathBufferBase::ScopedPush push(path, "de");
+        TEST_ASSERT_EQUAL(0, push.error());
+        TEST_ASSERT_EQUAL_STRING("/test_bd/abc/de", path.c_str());
+    }
+    TEST_ASSERT_EQUAL_STRING("/test_bd/abc", path.c_str());
+
+    TEST_ASSERT_EQUAL(0, path.dirname());
+    TEST_ASSERT_EQUAL_STRING("/test_bd", path.c_str());
+    TEST_ASSERT_EQUAL(0, path.dirname());
+    TEST_ASSERT_EQUAL_STRING("/", path.c_str());
+
+    TEST_ASSERT_EQUAL(0, path.assign("/a//b/./../c/"));
+    TEST_ASSERT_EQUAL(0, path.normalize());
+    TEST_ASSERT_EQUAL_STRING("/a/c", path.c_str());
+    TEST_ASSERT_EQUAL(4, path.size());
+
+    // absolute part replaces path
+    TEST_ASSERT_EQUAL(0, path.append("/b"));
+    TEST_ASSERT_EQUAL_STRING("/b", path.c_str());
+
+    // C-string functions
+    char buf[8];
+    TEST_ASSERT_EQUAL(0, join_paths(buf, sizeof(buf), "/ab", "cde"));
+    TEST_ASSERT_EQUAL_STRING("/ab/cde", buf);
+    TEST_ASSERT_NOT_EQUAL(0, join_paths(buf, sizeof(buf), "/ab", "cdef"));
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    errno = 0;
+    TEST_ASSERT_EQUAL_STRING("/ab/cde", buf);
+    TEST_ASSERT_NOT_EQUAL(0, join_paths(buf, sizeof(buf), "/a", "bcdefg"));
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    errno = 0;
+    TEST_ASSERT_EQUAL_STRING("/ab/cde", buf);
+    TEST_ASSERT_NOT_EQUAL(0, join_paths(buf, sizeof(buf), "/abcdefgh", "c"));
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    errno = 0;
+    TEST_ASSERT_EQUAL_STRING("/ab/cde", buf);
+    TEST_ASSERT_EQUAL(0, append_path(buf, sizeof(buf), "/x"));
+    TEST_ASSERT_EQUAL(0, append_path(buf, sizeof(buf), "yz"));
+    TEST_ASSERT_EQUAL_STRING("/x/yz", buf);
+    TEST_ASSERT_NOT_EQUAL(0, append_path(buf, sizeof(buf), "abc"));
+    TEST_ASSERT_EQUAL_STRING("/x/yz", buf);
+    errno = 0;
+}
+
+void test_join_paths_1()
+{
+    char buf[32];
+    const char *parts[] = {"/test_bd", "dev", "", "cfg"};
+
+    TEST_ASSERT_EQUAL(0, join_paths(buf, sizeof(buf), BASE_DIR, "dev", "12", "cfg/", "name.txt"));
+    TEST_ASSERT_EQUAL_STRING("/test_bd/dev/12/cfg/name.txt", buf);
+    TEST_ASSERT_EQUAL(0, join_paths(buf, sizeof(buf), "", "dev", "12"));
+    TEST_ASSERT_EQUAL_STRING("dev/12", buf);
+
+    // absolute part replaces previous ones
+    TEST_ASSERT_EQUAL(0, join_paths(buf, sizeof(buf), BASE_DIR, "dev", "/other", "cfg"));
+    TEST_ASSERT_EQUAL_STRING("/other/cfg", buf);
+    // replaced parts don't have to fit the buffer
+    char small_buf[8];
+    TEST_ASSERT_EQUAL(0, join_paths(small_buf, sizeof(small_buf), "/very/long/prefix", "/a", "b"));
+    TEST_ASSERT_EQUAL_STRING("/a/b", small_buf);
+
+    // array form
+    TEST_ASSERT_EQUAL(0, join_paths(buf, sizeof(buf), parts, 4));
+    TEST_ASSERT_EQUAL_STRING("/test_bd/dev/cfg", buf);
+    TEST_ASSERT_EQUAL(0, join_paths(buf, sizeof(buf), parts, 0));
+    TEST_ASSERT_EQUAL_STRING("", buf);
+
+    // insufficient buffer
+    TEST_ASSERT_NOT_EQUAL(0, join_paths(buf, sizeof(buf), BASE_DIR, "dev", "12", "cfg", "some_long_name.txt"));
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    errno = 0;
+}
+
+static_assert(static_join_paths("/test_bd", "config").equals("/test_bd/config"), "static_join_paths");
+static_assert(static_join_paths("/test_bd/", "config").equals("/test_bd/config"), "static_join_paths");
+static_assert(static_join_paths("/test_bd", "/config").equals("/config"), "static_join_paths");
+static_assert(static_join_paths("", "config").equals("config"), "static_join_paths");
+static_assert(static_join_paths(static_join_paths("/test_bd", "config"), "settings.txt").equals("/test_bd/config/settings.txt"), "static_join_paths");
+static_assert(static_normpath("").equals(""), "static_normpath");
+static_assert(static_normpath("/").equals("/"), "static_normpath");
+static_assert(static_normpath("abc/..").equals("."), "static_normpath");
+static_assert(static_normpath("/../test_bd").equals("/test_bd"), "static_normpath");
+static_assert(static_normpath("../../abc").equals("../../abc"), "static_normpath");
+static_assert(static_normpath("..//abc/./def").equals("../abc/def"), "static_normpath");
+static_assert(static_normpath("/test_bd//config/./device/../device/settings.txt/").equals("/test_bd/config/device/settings.txt"), "static_normpath");
+static_assert(static_dirname("/test_bd/config").equals("/test_bd"), "static_dirname");
+static_assert(static_dirname("/test_bd//config").equals("/test_bd"), "static_dirname");
+static_assert(static_dirname("/test_bd").equals("/"), "static_dirname");
+static_assert(static_dirname("config").equals(""), "static_dirname");
+static_assert(static_basename("/test_bd/config").equals("config"), "static_basename");
+static_assert(static_basename("/test_bd/").equals(""), "static_basename");
+static_assert(static_basename("config").equals("config"), "static_basename");
+
+#define CHECK_STATIC_PATH(path_l, path_r)                                           \
+    do {                                                                            \
+        constexpr auto joined_path = static_join_paths(path_l, path_r);             \
+        constexpr auto norm_path = static_normpath(joined_path);                    \
+        constexpr auto dir_path = static_dirname(joined_path);                      \
+        constexpr auto base_path = static_basename(joined_path);                    \
+        TEST_ASSERT_EQUAL(0, join_paths(buf, sizeof(buf), path_l, path_r));         \
+        TEST_ASSERT_EQUAL_STRING(buf, joined_path.c_str());                         \
+        TEST_ASSERT_EQUAL(strlen(buf), joined_path.size());                         \
+        TEST_ASSERT_EQUAL(0, basename(res_buf, sizeof(res_buf), buf));              \
+        TEST_ASSERT_EQUAL_STRING(res_buf, base_path.c_str());                       \
+        TEST_ASSERT_EQUAL(0, dirname(res_buf, sizeof(res_buf), buf));               \
+        TEST_ASSERT_EQUAL_STRING(res_buf, dir_path.c_str());                        \
+        normpath(buf);                                                              \
+        TEST_ASSERT_EQUAL_STRING(buf, norm_path.c_str());                           \
+        TEST_ASSERT_EQUAL(strlen(buf), norm_path.size());                           \
+    } while (0)
+
+void test_static_path_1()
+{
+    char buf[64];
+    char res_buf[64];
+
+    CHECK_STATIC_PATH("/test_bd", "config/settings.txt");
+    CHECK_STATIC_PATH("/test_bd/", "/config//");
+    CHECK_STATIC_PATH("", "./config");
+    CHECK_STATIC_PATH("/", "..");
+    CHECK_STATIC_PATH("..", "../abc/./..");
+    CHECK_STATIC_PATH("abc", "..");
+    CHECK_STATIC_PATH("//abc/", "/");
+    CHECK_STATIC_PATH("/test_bd/.config", "..hidden/file.");
+    CHECK_STATIC_PATH("a/b/../../..", "c/./d/");
+}
+
+void test_path_view_1()
+{
+    const char *parts[4];
+    size_t parts_num;
+    char buf[16];
+    PathView path("/test_bd//config/settings.txt/");
+
+    parts_num = 0;
+    for (PathView part : path) {
+        TEST_ASSERT_TRUE(parts_num < 4);
+        parts[parts_num++] = part.data();
+    }
+    TEST_ASSERT_EQUAL(3, parts_num);
+    TEST_ASSERT_EQUAL_PTR(path.data() + 1, parts[0]);
+    TEST_ASSERT_EQUAL_PTR(path.data() + 10, parts[1]);
+    TEST_ASSERT_EQUAL_PTR(path.data() + 17, parts[2]);
+    TEST_ASSERT_TRUE((*path.begin()).equals("test_bd"));
+
+    parts_num = 0;
+    for (PathView part : path.reversed()) {
+        TEST_ASSERT_TRUE(parts_num < 4);
+        parts[parts_num++] = part.data();
+    }
+    TEST_ASSERT_EQUAL(3, parts_num);
+    TEST_ASSERT_EQUAL_PTR(path.data() + 17, parts[0]);
+    TEST_ASSERT_EQUAL_PTR(path.data() + 1, parts[2]);
+    TEST_ASSERT_TRUE((*path.rbegin()).equals("settings.txt"));
+
+    TEST_ASSERT_TRUE(PathView("").begin() == PathView("").end());
+    TEST_ASSERT_TRUE(PathView("//").begin() == PathView("//").end());
+    TEST_ASSERT_TRUE(PathView("//").rbegin() == PathView("//").rend());
+
+    // parent and file name
+    TEST_ASSERT_TRUE(path.parent().equals("/test_bd//config/settings.txt"));
+    TEST_ASSERT_TRUE(path.parent().parent().equals("/test_bd//config"));
+    TEST_ASSERT_TRUE(path.parent().parent().parent().equals("/test_bd"));
+    TEST_ASSERT_TRUE(PathView("/test_bd").parent().equals("/"));
+    TEST_ASSERT_TRUE(PathView("config").parent().equals(""));
+    TEST_ASSERT_TRUE(path.filename().equals(""));
+    TEST_ASSERT_TRUE(path.parent().filename().equals("settings.txt"));
+    TEST_ASSERT_TRUE(path.parent().stem().equals("settings"));
+    TEST_ASSERT_TRUE(path.parent().extension().equals(".txt"));
+    TEST_ASSERT_TRUE(PathView("/test_bd/archive.tar.gz").stem().equals("archive.tar"));
+    TEST_ASSERT_TRUE(PathView("/test_bd/.config").stem().equals(".config"));
+    TEST_ASSERT_TRUE(PathView("/test_bd/.config").extension().equals(""));
+    TEST_ASSERT_TRUE(PathView("/test_bd/..").extension().equals(""));
+    TEST_ASSERT_TRUE(PathView("/test_bd.d/config").extension().equals(""));
+
+    // copy
+    TEST_ASSERT_EQUAL(0, path.parent().filename().copy(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("settings.txt", buf);
+    TEST_ASSERT_NOT_EQUAL(0, path.parent().copy(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    errno = 0;
+
+    // basename and dirname
+    TEST_ASSERT_EQUAL(0, basename(buf, sizeof(buf), "/test_bd/config"));
+    TEST_ASSERT_EQUAL_STRING("config", buf);
+    TEST_ASSERT_NOT_EQUAL(0, basename(buf, 6, "/test_bd/config"));
+    TEST_ASSERT_EQUAL(0, dirname(buf, sizeof(buf), "/test_bd//config"));
+    TEST_ASSERT_EQUAL_STRING("/test_bd", buf);
+    TEST_ASSERT_NOT_EQUAL(0, dirname(buf, 8, "/test_bd//config"));
+    strcpy(buf, "/test_bd/config");
+    TEST_ASSERT_EQUAL(0, dirname(buf));
+    TEST_ASSERT_EQUAL_STRING("/test_bd", buf);
+    TEST_ASSERT_EQUAL(0, dirname(buf, buf));
+    TEST_ASSERT_EQUAL_STRING("/", buf);
+    errno = 0;
+}
+
+void test_relpath_1()
+{
+    char buf[32];
+    const char *paths[] = {"/test_bd/config/device", "/test_bd//config/./settings.txt", "/test_bd/config_old/../config/a"};
+
+    TEST_ASSERT_EQUAL(0, relpath(buf, sizeof(buf), "/test_bd/data/log.txt", "/test_bd/config"));
+    TEST_ASSERT_EQUAL_STRING("../data/log.txt", buf);
+    TEST_ASSERT_EQUAL(0, relpath(buf, sizeof(buf), "/test_bd/config/device/", "/test_bd/./config"));
+    TEST_ASSERT_EQUAL_STRING("device", buf);
+    TEST_ASSERT_EQUAL(0, relpath(buf, sizeof(buf), "/test_bd", "/test_bd/config/device/.."));
+    TEST_ASSERT_EQUAL_STRING("..", buf);
+    TEST_ASSERT_EQUAL(0, relpath(buf, sizeof(buf), "/test_bd/config", "/test_bd//config/"));
+    TEST_ASSERT_EQUAL_STRING(".", buf);
+    TEST_ASSERT_EQUAL(0, relpath(buf, sizeof(buf), "/", "/test_bd/config"));
+    TEST_ASSERT_EQUAL_STRING("../..", buf);
+    TEST_ASSERT_EQUAL(0, relpath(buf, sizeof(buf), "../a/b", "../a/c"));
+    TEST_ASSERT_EQUAL_STRING("../b", buf);
+
+    // invalid arguments
+    TEST_ASSERT_NOT_EQUAL(0, relpath(buf, sizeof(buf), "/test_bd", "config"));
+    TEST_ASSERT_EQUAL(EINVAL, errno);
+    TEST_ASSERT_NOT_EQUAL(0, relpath(buf, sizeof(buf), "config", "../data"));
+    TEST_ASSERT_EQUAL(EINVAL, errno);
+    TEST_ASSERT_NOT_EQUAL(0, relpath(buf, sizeof(buf), "", "data"));
+    TEST_ASSERT_EQUAL(EINVAL, errno);
+    TEST_ASSERT_NOT_EQUAL(0, relpath(buf, 15, "/test_bd/data/log.txt", "/test_bd/config"));
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+
+    TEST_ASSERT_EQUAL(0, commonpath(buf, sizeof(buf), paths, 3));
+    TEST_ASSERT_EQUAL_STRING("/test_bd/config", buf);
+    TEST_ASSERT_EQUAL(0, commonpath(buf, sizeof(buf), paths, 1));
+    TEST_ASSERT_EQUAL_STRING("/test_bd/config/device", buf);
+    paths[2] = "/test_bd_2";
+    TEST_ASSERT_EQUAL(0, commonpath(buf, sizeof(buf), paths, 3));
+    TEST_ASSERT_EQUAL_STRING("/", buf);
+    paths[2] = "test_bd";
+    TEST_ASSERT_NOT_EQUAL(0, commonpath(buf, sizeof(buf), paths, 3));
+    TEST_ASSERT_EQUAL(EINVAL, errno);
+    TEST_ASSERT_NOT_EQUAL(0, commonpath(buf, sizeof(buf), paths, 0));
+    TEST_ASSERT_EQUAL(EINVAL, errno);
+    TEST_ASSERT_NOT_EQUAL(0, commonpath(buf, 8, paths, 2));
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    errno = 0;
+}
+
+void test_path_hash_1()
+{
+    const char *paths[][2] = {
+        {"/test_bd/config/settings.txt", "/test_bd//config/./device/../settings.txt/"},
+        {"/", "/../.."},
+        {".", "config/.."},
+        {"../config", "./..//config/"},
+        {"config", "config/"},
+    };
+
+    for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        TEST_ASSERT_TRUE(path_equal(paths[i][0], paths[i][1]));
+        TEST_ASSERT_TRUE(path_equal(paths[i][1], paths[i][0]));
+        TEST_ASSERT_EQUAL(path_hash(paths[i][0]), path_hash(paths[i][1]));
+    }
+
+    TEST_ASSERT_FALSE(path_equal("/test_bd/config", "test_bd/config"));
+    TEST_ASSERT_FALSE(path_equal("/test_bd/config", "/test_bd/config_2"));
+    TEST_ASSERT_TRUE(path_equal("/test_bd/config", "/test_bd/config/settings.txt/.."));
+    TEST_ASSERT_FALSE(path_equal("/test_bd/config", "/test_bd/config/settings.txt/../.."));
+    TEST_ASSERT_FALSE(path_equal("../config", "config"));
+    TEST_ASSERT_FALSE(path_equal("", "."));
+    TEST_ASSERT_TRUE(path_equal("", ""));
+    TEST_ASSERT_NOT_EQUAL(path_hash("/test_bd/config"), path_hash("test_bd/config"));
+    TEST_ASSERT_NOT_EQUAL(path_hash("/test_bd/config"), path_hash("/config/test_bd"));
+    TEST_ASSERT_NOT_EQUAL(path_hash("/test_bd/config"), path_hash("/test_bd/config/settings.txt"));
+}
+
+struct TrieEnumState {
+    size_t count;
+    size_t max_count;
+    char last_path[48];
+};
+
+static int trie_enum_callback(const char *path, void *context)
+{
+    TrieEnumState *state = (TrieEnumState *)context;
+    state->count++;
+    strcpy(state->last_path, path);
+    return state->count >= state->max_count ? 1 : 0;
+}
+
+void test_path_trie_1()
+{
+    uint32_t arena_buff[64];
+    char buf[48];
+    PathArena arena(arena_buff, sizeof(arena_buff));
+    PathTrie trie(arena);
+    PathTrie::NodeId id;
+    TrieEnumState state;
+    const char *paths[] = {"/test_bd/config/device/settings.txt", "/test_bd/config/device", "/test_bd/data", "test_bd/config"};
+
+    for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); i++) {
+        TEST_ASSERT_EQUAL(0, trie.insert(paths[i]));
+    }
+    TEST_ASSERT_EQUAL(0, trie.insert("/test_bd/./config//device/"));
+    TEST_ASSERT_EQUAL(4, trie.size());
+    // 2 roots, "test_bd", "config", "device", "settings.txt", "data" and relative "test_bd", "config"
+    TEST_ASSERT_EQUAL(9, trie.node_count());
+    TEST_ASSERT_TRUE(trie.memory_used() <= arena.used());
+    // nodes take 16 bytes plus names (48 bytes) and alignment
+    TEST_ASSERT_TRUE(trie.memory_used() >= 9 * 16 + 48);
+    TEST_ASSERT_TRUE(trie.memory_used() <= 9 * 16 + 48 + 9 * 3);
+
+    // lookup and reconstruction
+    TEST_ASSERT_EQUAL(0, trie.lookup("/test_bd/data/../config/device/settings.txt", &id));
+    TEST_ASSERT_EQUAL(0, trie.get_path(id, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("/test_bd/config/device/settings.txt", buf);
+    TEST_ASSERT_NOT_EQUAL(0, trie.get_path(id, buf, 35));
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    TEST_ASSERT_NOT_EQUAL(0, trie.lookup("/test_bd/config"));
+    TEST_ASSERT_EQUAL(ENOENT, errno);
+    TEST_ASSERT_NOT_EQUAL(0, trie.lookup("/test_bd/other"));
+    TEST_ASSERT_EQUAL(ENOENT, errno);
+    TEST_ASSERT_EQUAL(0, trie.lookup("test_bd/config/", &id));
+    TEST_ASSERT_EQUAL(0, trie.get_path(id, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL_STRING("test_bd/config", buf);
+
+    // enumeration
+    memset(&state, 0, sizeof(state));
+    state.max_count = 100;
+    TEST_ASSERT_EQUAL(0, trie.enumerate("/test_bd/config", buf, sizeof(buf), trie_enum_callback, &state));
+    TEST_ASSERT_EQUAL(2, state.count);
+    TEST_ASSERT_EQUAL_STRING("/test_bd/config/device/settings.txt", state.last_path);
+    memset(&state, 0, sizeof(state));
+    state.max_count = 100;
+    TEST_ASSERT_EQUAL(0, trie.enumerate("/", buf, sizeof(buf), trie_enum_callback, &state));
+    TEST_ASSERT_EQUAL(3, state.count);
+    memset(&state, 0, sizeof(state));
+    state.max_count = 100;
+    TEST_ASSERT_EQUAL(0, trie.enumerate(".", buf, sizeof(buf), trie_enum_callback, &state));
+    TEST_ASSERT_EQUAL(1, state.count);
+    TEST_ASSERT_EQUAL_STRING("test_bd/config", state.last_path);
+    memset(&state, 0, sizeof(state));
+    state.max_count = 2;
+    TEST_ASSERT_EQUAL(1, trie.enumerate("/", buf, sizeof(buf), trie_enum_callback, &state));
+    TEST_ASSERT_EQUAL(2, state.count);
+
+    // errors
+    TEST_ASSERT_NOT_EQUAL(0, trie.insert(""));
+    TEST_ASSERT_EQUAL(EINVAL, errno);
+    TEST_ASSERT_NOT_EQUAL(0, trie.insert("/test_bd/some/very/long/path/that/does/not/fit/arena/buffer"));
+    TEST_ASSERT_EQUAL(ENOBUFS, errno);
+    TEST_ASSERT_EQUAL(4, trie.size());
+
+    trie.clear();
+    arena.reset();
+    TEST_ASSERT_EQUAL(0, trie.size());
+    TEST_ASSERT_NOT_EQUAL(0, trie.lookup("/test_bd/data"));
+    TEST_ASSERT_EQUAL(0, trie.insert("/test_bd/data"));
+    TEST_ASSERT_EQUAL(0, trie.lookup("/test_bd/data"));
+    errno = 0;
+}
+
+void test_fnmatch_1()
+{
+    const char *matched[][2] = {
+        {"settings.txt", "settings.txt"},
+        {"*.log", "boot.log"},
+        {"*.log", ".log"},
+        {"cfg_??.bin", "cfg_01.bin"},
+        {"cfg_*", "cfg_"},
+        {"*_[0-9].bin", "cfg_3.bin"},
+        {"*_[!0-9].bin", "cfg_a.bin"},
+        {"[]a]", "]"},
+        {"a[", "a["},
+        {"\\*.txt", "*.txt"},
+        {"**/tmp/*", "tmp/a.log"},
+        {"**/tmp/*", "test_bd/var/tmp/a.log"},
+        {"/test_bd/**/*.txt", "/test_bd/settings.txt"},
+        {"/test_bd/**/*.txt", "/test_bd/config/device/settings.txt"},
+        {"/test_bd/**", "/test_bd/config/device"},
+        {"/test_bd/*/*.txt", "/test_bd/config/settings.txt"},
+        {"*a*b*c", "xaxbxbxc"},
+    };
+    const char *not_matched[][2] = {
+        {"settings.txt", "settings.txt2"},
+        {"*.log", "boot.log.1"},
+        {"cfg_??.bin", "cfg_1.bin"},
+        {"*_[0-9].bin", "cfg_a.bin"},
+        {"*_[!0-9].bin", "cfg_3.bin"},
+        {"\\*.txt", "a.txt"},
+        {"*.txt", "config/settings.txt"},
+        {"cfg?bin", "cfg/bin"},
+        {"**/tmp/*", "tmp/var/a.log"},
+        {"**/tmp/*", "var_tmp/a.log"},
+        {"/test_bd/*/*.txt", "/test_bd/config/device/settings.txt"},
+        {"/test_bd/a**/*.txt", "/test_bd/ab/cd/settings.txt"},
+        {"*a*b*c", "xaxbxbxcx"},
+    };
+    GlobPattern pattern;
+
+    for (size_t i = 0; i < sizeof(matched) / sizeof(matched[0]); i++) {
+        TEST_ASSERT_TRUE_MESSAGE(fnmatch(matched[i][0], matched[i][1]), matched[i][0]);
+    }
+    for (size_t i = 0; i < sizeof(not_matched) / sizeof(not_matched[0]); i++) {
+        TEST_ASSERT_FALSE_MESSAGE(fnmatch(not_matched[i][0], not_matched[i][1]), not_matched[i][0]);
+    }
+
+    TEST_ASSERT_FALSE(pattern.match("a"));
+    TEST_ASSERT_EQUAL(0, pattern.compile("file_?.txt"));
+    TEST_ASSERT_TRUE(pattern.match("file_1.txt"));
+    TEST_ASSERT_TRUE(pattern.match("file_1.txt.bak", 10));
+    TEST_ASSERT_FALSE(pattern.match("file_12.txt"));
+    TEST_ASSERT_NOT_EQUAL(0, pattern.compile("file\\"));
+    TEST_ASSERT_EQUAL(EINVAL, errno);
+    TEST_ASSERT_FALSE(pattern.match("file\\"));
+    TEST_ASSERT_FALSE(fnmatch("file\\", "file\\"));
+    errno = 0;
+}
+
 // test cases description
 #define FSSimpleCase(test_fun) Case(#test_fun, case_setup_handler, test_fun, case_teardown_handler, greentea_case_failure_continue_handler)
 Case cases[] = {
@@ -566,20 +2002,51 @@ Case cases[] = {
     FSSimpleCase(test_read_data_1),
     FSSimpleCase(test_write_str_1),
     FSSimpleCase(test_read_str_1),
+    FSSimpleCase(test_read_chunks_1),
+    FSSimpleCase(test_file_reader_1),
+    FSSimpleCase(test_map_file_1),
     FSSimpleCase(test_makedirs_1),
+    FSSimpleCase(test_makedirs_2),
+    FSSimpleCase(test_makedirs_3),
+    FSSimpleCase(test_makedirs_batch_1),
+    FSSimpleCase(test_stat_cache_1),
     FSSimpleCase(test_rmtree_1),
     FSSimpleCase(test_rmtree_2),
     FSSimpleCase(test_rmtree_3),
     FSSimpleCase(test_rmtree_4),
+    FSSimpleCase(test_rmtree_5),
+    FSSimpleCase(test_rmtree_6),
     FSSimpleCase(test_cleartree_1),
     FSSimpleCase(test_cleartree_2),
     FSSimpleCase(test_cleartree_3),
+    FSSimpleCase(test_cleartree_4),
+    FSSimpleCase(test_tree_remover_1),
+    FSSimpleCase(test_tree_remover_2),
+    FSSimpleCase(test_tree_remover_3),
+    FSSimpleCase(test_walk_1),
+    FSSimpleCase(test_tree_walker_1),
+    FSSimpleCase(test_disk_usage_1),
     FSSimpleCase(test_isdir_1),
     FSSimpleCase(test_isfile_1),
     FSSimpleCase(test_exists_1),
     FSSimpleCase(test_getsize_1),
+    FSSimpleCase(test_path_info_1),
+    FSSimpleCase(test_stat_batch_1),
+    FSSimpleCase(test_stat_batch_2),
     FSSimpleCase(test_readdir_child_1),
     FSSimpleCase(test_readdir_child_2),
+    FSSimpleCase(test_readdir_match_1),
+    FSSimpleCase(test_dir_listing_1),
+    FSSimpleCase(test_normpath_1),
+    FSSimpleCase(test_normpath_batch_1),
+    FSSimpleCase(test_path_buffer_1),
+    FSSimpleCase(test_join_paths_1),
+    FSSimpleCase(test_static_path_1),
+    FSSimpleCase(test_path_view_1),
+    FSSimpleCase(test_relpath_1),
+    FSSimpleCase(test_path_hash_1),
+    FSSimpleCase(test_path_trie_1),
+    FSSimpleCase(test_fnmatch_1),
 };
 Specification specification(greentea_test_setup_handler, cases, greentea_test_teardown_handler);
 
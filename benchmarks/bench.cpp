@@ -0,0 +1,229 @@
+#include "bench.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pathutil.h"
+
+using namespace bench;
+
+std::atomic<unsigned long> bench::syscall_counters[SYSCALL_COUNT];
+
+static const char *const SYSCALL_NAMES[SYSCALL_COUNT] = {
+    "stat",
+    "lstat",
+    "fstat",
+    "mkdir",
+    "remove",
+    "opendir",
+    "readdir",
+    "closedir",
+    "open",
+    "read",
+    "write",
+    "lseek",
+    "close",
+    "openat",
+    "fdopendir",
+    "fstatat",
+    "mkdirat",
+    "unlinkat",
+    "rmdir",
+    "mmap",
+    "munmap",
+    "madvise",
+};
+
+const char *bench::syscall_name(int id)
+{
+    if (id < 0 || id >= SYSCALL_COUNT) {
+        return "unknown";
+    }
+    return SYSCALL_NAMES[id];
+}
+
+void bench::check(bool ok, const char *expr, const char *file, int line)
+{
+    if (!ok) {
+        fprintf(stderr, "%s:%i: check \"%s\" has failed (errno: %i)\n", file, line, expr, errno);
+        exit(1);
+    }
+}
+
+static uint64_t monotonic_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+//--------------------------------------------------------------------------------
+// Context
+//--------------------------------------------------------------------------------
+
+Context::Context(const char *work_dir, bool quick)
+    : _work_dir(work_dir)
+    , _quick(quick)
+    , _start_ns(0)
+    , _elapsed_ns(0)
+{
+    memset(_start_syscalls, 0, sizeof(_start_syscalls));
+    memset(_syscalls, 0, sizeof(_syscalls));
+}
+
+size_t Context::iterations(size_t n) const
+{
+    if (_quick) {
+        n /= 100;
+    }
+    return n > 0 ? n : 1;
+}
+
+void Context::start()
+{
+    for (int i = 0; i < SYSCALL_COUNT; i++) {
+        _start_syscalls[i] = syscall_counters[i].load(std::memory_order_relaxed);
+    }
+    _start_ns = monotonic_ns();
+}
+
+void Context::stop()
+{
+    _elapsed_ns += monotonic_ns() - _start_ns;
+    for (int i = 0; i < SYSCALL_COUNT; i++) {
+        _syscalls[i] += syscall_counters[i].load(std::memory_order_relaxed) - _start_syscalls[i];
+    }
+}
+
+void Context::report(const char *name, uint64_t ops)
+{
+    double ns_per_op = ops ? (double)_elapsed_ns / ops : 0.0;
+    double ops_per_sec = _elapsed_ns ? ops * 1e9 / _elapsed_ns : 0.0;
+    unsigned long syscalls_total = 0;
+    for (int i = 0; i < SYSCALL_COUNT; i++) {
+        syscalls_total += _syscalls[i];
+    }
+
+    printf("%-40s %10llu %14.1f %14.0f", name, (unsigned long long)ops, ns_per_op, ops_per_sec);
+    if (syscall_counters_enabled && ops) {
+        printf(" %12.2f ", (double)syscalls_total / ops);
+        for (int i = 0; i < SYSCALL_COUNT; i++) {
+            if (_syscalls[i]) {
+                printf(" %s=%.2f", syscall_name(i), (double)_syscalls[i] / ops);
+            }
+        }
+    } else {
+        printf(" %12s ", "n/a");
+    }
+    printf("\n");
+    fflush(stdout);
+
+    _elapsed_ns = 0;
+    memset(_syscalls, 0, sizeof(_syscalls));
+}
+
+//--------------------------------------------------------------------------------
+// Case registry
+//--------------------------------------------------------------------------------
+
+#define MAX_CASES 128
+
+struct CaseEntry {
+    const char *name;
+    CaseFunc func;
+};
+
+static CaseEntry registered_cases[MAX_CASES];
+static int registered_cases_num = 0;
+
+Registrar::Registrar(const char *name, CaseFunc func)
+{
+    if (registered_cases_num >= MAX_CASES) {
+        fprintf(stderr, "Too many benchmark cases. Case \"%s\" is ignored\n", name);
+        return;
+    }
+    registered_cases[registered_cases_num].name = name;
+    registered_cases[registered_cases_num].func = func;
+    registered_cases_num++;
+}
+
+int bench::run_cases(Context &ctx, const char *filter)
+{
+    int count = 0;
+
+    printf("%-40s %10s %14s %14s %12s  %s\n", "benchmark", "ops", "ns/op", "ops/sec", "syscalls/op", "syscalls details");
+    for (int i = 0; i < registered_cases_num; i++) {
+        if (filter != NULL && strstr(registered_cases[i].name, filter) == NULL) {
+            continue;
+        }
+        registered_cases[i].func(ctx);
+        count++;
+    }
+    return count;
+}
+
+//--------------------------------------------------------------------------------
+// file system fixtures
+//--------------------------------------------------------------------------------
+
+static int make_tree_impl(char *path, size_t path_len, int depth, int width, int files, const uint8_t *data, size_t file_size)
+{
+    int file;
+    ssize_t write_res;
+
+    if (mkdir(path, 0777)) {
+        return -1;
+    }
+    for (int i = 0; i < files; i++) {
+        sprintf(path + path_len, "/file_%i.dat", i);
+        if ((file = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0666)) < 0) {
+            return -1;
+        }
+        write_res = write(file, data, file_size);
+        if (close(file) || write_res != (ssize_t)file_size) {
+            return -1;
+        }
+    }
+    if (depth > 0) {
+        for (int i = 0; i < width; i++) {
+            int sub_path_len = sprintf(path + path_len, "/dir_%i", i);
+            if (make_tree_impl(path, path_len + sub_path_len, depth - 1, width, files, data, file_size)) {
+                return -1;
+            }
+        }
+    }
+    path[path_len] = '\0';
+    return 0;
+}
+
+int bench::make_tree(const char *path, int depth, int width, int files, size_t file_size)
+{
+    char path_buf[512];
+    uint8_t data[4096];
+    size_t path_len = strlen(path);
+
+    if (path_len + 32 * (depth + 1) > sizeof(path_buf) || file_size > sizeof(data)) {
+        errno = ENOBUFS;
+        return -1;
+    }
+    memset(data, 0xA5, file_size);
+    strcpy(path_buf, path);
+    return make_tree_impl(path_buf, path_len, depth, width, files, data, file_size);
+}
+
+unsigned long bench::tree_entries(int depth, int width, int files)
+{
+    unsigned long dirs = 1;
+    unsigned long level_dirs = 1;
+    for (int i = 0; i < depth; i++) {
+        level_dirs *= width;
+        dirs += level_dirs;
+    }
+    return dirs * (files + 1);
+}
@@ -0,0 +1,198 @@
+#ifndef PATHUTIL_BENCH_H
+#define PATHUTIL_BENCH_H
+
+/**
+ * Minimal benchmark harness for host builds of the pathutil library.
+ *
+ * Each benchmark case measures one or more operations between Context::start() and Context::stop()
+ * calls and reports the result with Context::report(). Besides timing, the harness counts file system
+ * calls, that are done by the library. The counters are collected by the linker level wrappers
+ * (see bench_syscalls.cpp), so they are available only if the executable is linked with them.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+namespace bench {
+
+/**
+ * Identifiers of the counted file system calls.
+ */
+enum SyscallId {
+    SYSCALL_STAT = 0,
+    SYSCALL_LSTAT,
+    SYSCALL_FSTAT,
+    SYSCALL_MKDIR,
+    SYSCALL_REMOVE,
+    SYSCALL_OPENDIR,
+    SYSCALL_READDIR,
+    SYSCALL_CLOSEDIR,
+    SYSCALL_OPEN,
+    SYSCALL_READ,
+    SYSCALL_WRITE,
+    SYSCALL_LSEEK,
+    SYSCALL_CLOSE,
+    SYSCALL_OPENAT,
+    SYSCALL_FDOPENDIR,
+    SYSCALL_FSTATAT,
+    SYSCALL_MKDIRAT,
+    SYSCALL_UNLINKAT,
+    SYSCALL_RMDIR,
+    SYSCALL_MMAP,
+    SYSCALL_MUNMAP,
+    SYSCALL_MADVISE,
+    SYSCALL_COUNT
+};
+
+/**
+ * Global counters of the file system calls.
+ *
+ * Counters are atomic, as the multithreaded functions call wrappers from several threads.
+ * They are updated with relaxed ordering, because only the totals are read between benchmark steps.
+ */
+extern std::atomic<unsigned long> syscall_counters[SYSCALL_COUNT];
+
+/**
+ * Check if file system calls are counted by this executable.
+ */
+extern const bool syscall_counters_enabled;
+
+/**
+ * Get printable name of the file system call.
+ */
+const char *syscall_name(int id);
+
+/**
+ * Abort benchmark execution if \p ok is \c false.
+ *
+ * Benchmarks are run as smoke tests, so any failed operation should be reported as error.
+ */
+void check(bool ok, const char *expr, const char *file, int line);
+
+/**
+ * Prevent compiler from optimizing out computation of the value.
+ */
+template <typename T>
+inline void do_not_optimize(T const &value)
+{
+    asm volatile(""
+                 :
+                 : "r,m"(value)
+                 : "memory");
+}
+
+/**
+ * Benchmark execution context.
+ */
+class Context {
+public:
+    Context(const char *work_dir, bool quick);
+
+    /**
+     * Get directory that can be used by benchmarks to create files.
+     */
+    const char *work_dir() const
+    {
+        return _work_dir;
+    }
+
+    /**
+     * Check if benchmarks are run in the smoke test mode.
+     */
+    bool quick() const
+    {
+        return _quick;
+    }
+
+    /**
+     * Get number of iterations for a benchmark.
+     *
+     * @param n number of iterations in the normal mode
+     * @return number of iterations in the current mode
+     */
+    size_t iterations(size_t n) const;
+
+    /**
+     * Start measured section.
+     */
+    void start();
+
+    /**
+     * Stop measured section and accumulate its results.
+     */
+    void stop();
+
+    /**
+     * Get accumulated time of the measured sections.
+     */
+    uint64_t elapsed_ns() const
+    {
+        return _elapsed_ns;
+    }
+
+    /**
+     * Print accumulated results and reset them.
+     *
+     * @param name benchmark name
+     * @param ops number of operations that have been done in the measured sections
+     */
+    void report(const char *name, uint64_t ops);
+
+private:
+    const char *_work_dir;
+    bool _quick;
+
+    uint64_t _start_ns;
+    uint64_t _elapsed_ns;
+    unsigned long _start_syscalls[SYSCALL_COUNT];
+    unsigned long _syscalls[SYSCALL_COUNT];
+};
+
+typedef void (*CaseFunc)(Context &ctx);
+
+/**
+ * Helper object to register benchmark case.
+ */
+struct Registrar {
+    Registrar(const char *name, CaseFunc func);
+};
+
+/**
+ * Run registered benchmark cases, whose names contain \p filter.
+ *
+ * @return number of executed cases
+ */
+int run_cases(Context &ctx, const char *filter);
+
+//--------------------------------------------------------------------------------
+// file system fixtures
+//--------------------------------------------------------------------------------
+
+/**
+ * Create directory tree.
+ *
+ * @param path root directory of the tree. It shouldn't exist.
+ * @param depth number of directory levels below the root
+ * @param width number of subdirectories in each directory
+ * @param files number of files in each directory
+ * @param file_size size of each file
+ * @return 0 on success, otherwise non-zero value
+ */
+int make_tree(const char *path, int depth, int width, int files, size_t file_size);
+
+/**
+ * Get number of entries (files and directories), that are created by make_tree including root directory.
+ */
+unsigned long tree_entries(int depth, int width, int files);
+}
+
+#define BENCH_CHECK(expr) bench::check((expr), #expr, __FILE__, __LINE__)
+
+#define BENCH_CASE(func_name)                                                       \
+    static void func_name(bench::Context &ctx);                                     \
+    static const bench::Registrar func_name##_registrar(#func_name, func_name); \
+    static void func_name(bench::Context &ctx)
+
+#endif // PATHUTIL_BENCH_H
@@ -0,0 +1,744 @@
+/**
+ * Benchmarks of the file system functions.
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "pathutil.h"
+
+using namespace bench;
+
+static void bench_makedirs_depth(Context &ctx, const char *name, int depth)
+{
+    char root[256];
+    char path[512];
+    const size_t n = ctx.iterations(1000);
+
+    pathutil::join_paths(root, sizeof(root), ctx.work_dir(), "makedirs");
+    strcpy(path, root);
+    for (int i = 0; i < depth; i++) {
+        pathutil::append_path(path, sizeof(path), "level");
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        ctx.start();
+        BENCH_CHECK(pathutil::makedirs(path) == 0);
+        ctx.stop();
+        BENCH_CHECK(pathutil::rmtree(root) == 0);
+    }
+    ctx.report(name, n);
+}
+
+BENCH_CASE(bench_makedirs)
+{
+    char path[256];
+    const size_t n = ctx.iterations(20000);
+
+    bench_makedirs_depth(ctx, "makedirs/new_depth_2", 2);
+    bench_makedirs_depth(ctx, "makedirs/new_depth_8", 8);
+
+    pathutil::join_paths(path, sizeof(path), ctx.work_dir(), "makedirs/a/b/c/d");
+    BENCH_CHECK(pathutil::makedirs(path) == 0);
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::makedirs(path, 0777, true) == 0);
+    }
+    ctx.stop();
+    ctx.report("makedirs/existing_depth_4", n);
+    pathutil::join_paths(path, sizeof(path), ctx.work_dir(), "makedirs");
+    BENCH_CHECK(pathutil::rmtree(path) == 0);
+}
+
+/**
+ * Compare makedirs strategies, when only \p missing last levels of \p depth ones don't exist.
+ *
+ * Report name contains average number of stat (s) and mkdir (m) calls, that are counted by the library.
+ */
+static void bench_makedirs_strategy(Context &ctx, const char *name, pathutil::MakedirsStrategy strategy, int depth, int missing)
+{
+    char root[256];
+    char path[512];
+    char report_name[128];
+    char *existing_end = NULL;
+    const size_t n = ctx.iterations(1000);
+    pathutil::MakedirsStats stats;
+    uint64_t stat_calls = 0;
+    uint64_t mkdir_calls = 0;
+
+    pathutil::join_paths(root, sizeof(root), ctx.work_dir(), "makedirs");
+    strcpy(path, root);
+    for (int i = 0; i < depth; i++) {
+        if (i == depth - missing) {
+            existing_end = path + strlen(path);
+        }
+        pathutil::append_path(path, sizeof(path), "level");
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (existing_end != NULL) {
+            // create existing part of the path
+            *existing_end = '\0';
+            BENCH_CHECK(pathutil::makedirs(path) == 0);
+            *existing_end = '/';
+        } else {
+            BENCH_CHECK(pathutil::makedirs(path, 0777, true) == 0);
+        }
+        ctx.start();
+        BENCH_CHECK(pathutil::makedirs(path, 0777, true, NULL, 0, strategy, &stats) == 0);
+        ctx.stop();
+        stat_calls += stats.stat_calls;
+        mkdir_calls += stats.mkdir_calls;
+        if (existing_end != NULL) {
+            BENCH_CHECK(pathutil::rmtree(root) == 0);
+        }
+    }
+    snprintf(report_name, sizeof(report_name), "%s(s=%.0f m=%.0f)", name,
+             (double)stat_calls / n, (double)mkdir_calls / n);
+    ctx.report(report_name, n);
+    if (existing_end == NULL) {
+        BENCH_CHECK(pathutil::rmtree(root) == 0);
+    }
+}
+
+BENCH_CASE(bench_makedirs_strategies)
+{
+    static const struct {
+        const char *name;
+        int depth;
+        int missing;
+    } shapes[] = {
+        {"d2_new1", 2, 1},
+        {"d2_new2", 2, 2},
+        {"d8_new1", 8, 1},
+        {"d8_new8", 8, 8},
+        {"d8_existing", 8, 0},
+    };
+    char name[96];
+
+    for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+        snprintf(name, sizeof(name), "makedirs/stat/%s", shapes[i].name);
+        bench_makedirs_strategy(ctx, name, pathutil::MAKEDIRS_STAT_FIRST, shapes[i].depth, shapes[i].missing);
+        snprintf(name, sizeof(name), "makedirs/mkdir/%s", shapes[i].name);
+        bench_makedirs_strategy(ctx, name, pathutil::MAKEDIRS_MKDIR_FIRST, shapes[i].depth, shapes[i].missing);
+    }
+}
+
+/**
+ * Create 40 sibling directories under 4 roots with makedirs loop and makedirs_batch.
+ */
+static void bench_makedirs_batch_run(Context &ctx, const char *name, bool use_batch, bool existing)
+{
+    enum { ROOTS = 4, DIRS_PER_ROOT = 10, DIRS = ROOTS * DIRS_PER_ROOT };
+    static char path_data[DIRS][320];
+    const char *paths[DIRS];
+    char root[256];
+    char report_name[96];
+    const size_t n = ctx.iterations(200);
+    pathutil::MakedirsStats stats;
+    uint64_t stat_calls = 0;
+    uint64_t mkdir_calls = 0;
+
+    pathutil::join_paths(root, sizeof(root), ctx.work_dir(), "makedirs_batch");
+    for (int i = 0; i < DIRS; i++) {
+        snprintf(path_data[i], sizeof(path_data[i]), "%s/app/root_%i/dir_%i", root, i % ROOTS, i / ROOTS);
+        paths[i] = path_data[i];
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (existing && i == 0) {
+            BENCH_CHECK(pathutil::makedirs_batch(paths, DIRS) == 0);
+        }
+        ctx.start();
+        if (use_batch) {
+            BENCH_CHECK(pathutil::makedirs_batch(paths, DIRS, 0777, NULL, NULL, 0, &stats) == 0);
+            stat_calls += stats.stat_calls;
+            mkdir_calls += stats.mkdir_calls;
+        } else {
+            for (int j = 0; j < DIRS; j++) {
+                BENCH_CHECK(pathutil::makedirs(paths[j], 0777, true, NULL, 0, pathutil::MAKEDIRS_STAT_FIRST, &stats) == 0);
+                stat_calls += stats.stat_calls;
+                mkdir_calls += stats.mkdir_calls;
+            }
+        }
+        ctx.stop();
+        if (!existing) {
+            BENCH_CHECK(pathutil::rmtree(root) == 0);
+        }
+    }
+    snprintf(report_name, sizeof(report_name), "%s(s=%.0f m=%.0f)", name,
+             (double)stat_calls / n, (double)mkdir_calls / n);
+    ctx.report(report_name, n);
+    if (existing) {
+        BENCH_CHECK(pathutil::rmtree(root) == 0);
+    }
+}
+
+BENCH_CASE(bench_makedirs_batch)
+{
+    bench_makedirs_batch_run(ctx, "makedirs_loop/new_40", false, false);
+    bench_makedirs_batch_run(ctx, "makedirs_batch/new_40", true, false);
+    bench_makedirs_batch_run(ctx, "makedirs_loop/existing_40", false, true);
+    bench_makedirs_batch_run(ctx, "makedirs_batch/existing_40", true, true);
+}
+
+static void bench_rmtree_shape(Context &ctx, const char *name, bool remove_root, int depth, int width, int files, size_t max_open_dirs = 0)
+{
+    char path[256];
+    const size_t n = ctx.iterations(100);
+    const unsigned long entries = tree_entries(depth, width, files);
+    int ret_code;
+
+    pathutil::join_paths(path, sizeof(path), ctx.work_dir(), "tree");
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(make_tree(path, depth, width, files, 16) == 0);
+        ctx.start();
+        if (remove_root) {
+            ret_code = pathutil::rmtree(path, NULL, 0, max_open_dirs);
+        } else {
+            ret_code = pathutil::cleartree(path, NULL, 0, max_open_dirs);
+        }
+        ctx.stop();
+        BENCH_CHECK(ret_code == 0);
+        if (!remove_root) {
+            BENCH_CHECK(pathutil::rmtree(path) == 0);
+        }
+    }
+    // report results per removed entry
+    ctx.report(name, n * entries);
+}
+
+BENCH_CASE(bench_rmtree)
+{
+    bench_rmtree_shape(ctx, "rmtree/flat_64_files(per entry)", true, 0, 0, 64);
+    bench_rmtree_shape(ctx, "rmtree/d3_w4_f4(per entry)", true, 3, 4, 4);
+    bench_rmtree_shape(ctx, "rmtree/d12_w1_f1(per entry)", true, 12, 1, 1);
+    bench_rmtree_shape(ctx, "rmtree/d3_w4_f4_open_1(per entry)", true, 3, 4, 4, 1);
+    bench_rmtree_shape(ctx, "rmtree/d12_w1_f1_open_1(per entry)", true, 12, 1, 1, 1);
+}
+
+BENCH_CASE(bench_cleartree)
+{
+    bench_rmtree_shape(ctx, "cleartree/flat_64_files(per entry)", false, 0, 0, 64);
+    bench_rmtree_shape(ctx, "cleartree/d3_w4_f4(per entry)", false, 3, 4, 4);
+}
+
+static void bench_tree_remover_steps(Context &ctx, const char *name, size_t step_entries)
+{
+    char path[256];
+    char report_name[96];
+    const size_t n = ctx.iterations(100);
+    const int depth = 3, width = 4, files = 4;
+    uint64_t steps = 0;
+    int ret_code;
+
+    pathutil::join_paths(path, sizeof(path), ctx.work_dir(), "tree");
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(make_tree(path, depth, width, files, 16) == 0);
+        pathutil::TreeRemover remover;
+        ctx.start();
+        ret_code = remover.start(path);
+        while (ret_code == 0 && (ret_code = remover.step(step_entries)) > 0) {
+            steps++;
+            ret_code = 0;
+        }
+        ctx.stop();
+        BENCH_CHECK(ret_code == 0);
+        steps++;
+    }
+    // report results per step
+    snprintf(report_name, sizeof(report_name), "%s(per step)", name);
+    ctx.report(report_name, steps);
+}
+
+BENCH_CASE(bench_tree_remover)
+{
+    bench_tree_remover_steps(ctx, "tree_remover/d3_w4_f4_step_1", 1);
+    bench_tree_remover_steps(ctx, "tree_remover/d3_w4_f4_step_16", 16);
+}
+
+/**
+ * Recursive traversal, that is usually written around readdir_child: full paths and stat call per entry.
+ */
+static int naive_walk(const char *path, unsigned long &entries)
+{
+    char child_path[256];
+    struct dirent *dir_ent;
+    struct stat entry_stat;
+    DIR *dir;
+    int ret_code = 0;
+
+    if ((dir = opendir(path)) == NULL) {
+        return -1;
+    }
+    while (ret_code == 0 && (dir_ent = pathutil::readdir_child(dir)) != NULL) {
+        pathutil::join_paths(child_path, sizeof(child_path), path, dir_ent->d_name);
+        if (stat(child_path, &entry_stat)) {
+            ret_code = -1;
+        } else if (S_ISDIR(entry_stat.st_mode)) {
+            ret_code = naive_walk(child_path, entries);
+        }
+        entries++;
+    }
+    closedir(dir);
+    return ret_code;
+}
+
+static int count_walk_callback(const pathutil::WalkEntry &entry, void *context)
+{
+    if (entry.event != pathutil::WALK_POST_DIR) {
+        (*(unsigned long *)context)++;
+    }
+    return pathutil::WALK_CONTINUE;
+}
+
+static void bench_walk_shape(Context &ctx, const char *name, int depth, int width, int files, size_t max_open_dirs)
+{
+    char path[256];
+    char buff[256];
+    char report_name[96];
+    const size_t n = ctx.iterations(100);
+    const unsigned long entries = tree_entries(depth, width, files);
+    unsigned long counted;
+
+    pathutil::join_paths(path, sizeof(path), ctx.work_dir(), "tree");
+    BENCH_CHECK(make_tree(path, depth, width, files, 16) == 0);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        counted = 1;
+        BENCH_CHECK(naive_walk(path, counted) == 0);
+        BENCH_CHECK(counted == entries);
+    }
+    ctx.stop();
+    snprintf(report_name, sizeof(report_name), "walk_naive/%s", name);
+    ctx.report(report_name, n * entries);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        counted = 0;
+        BENCH_CHECK(pathutil::walk(path, count_walk_callback, &counted, buff, sizeof(buff), 0, max_open_dirs) == 0);
+        BENCH_CHECK(counted == entries);
+    }
+    ctx.stop();
+    snprintf(report_name, sizeof(report_name), "walk/%s_open_%u", name, (unsigned)max_open_dirs);
+    ctx.report(report_name, n * entries);
+
+    BENCH_CHECK(pathutil::rmtree(path) == 0);
+}
+
+BENCH_CASE(bench_walk)
+{
+    bench_walk_shape(ctx, "d3_w4_f4", 3, 4, 4, 4);
+    bench_walk_shape(ctx, "d3_w4_f4", 3, 4, 4, 1);
+    bench_walk_shape(ctx, "d12_w1_f1", 12, 1, 1, 4);
+}
+
+/**
+ * Recursive disk usage, that is usually written around readdir_child: full paths and stat call per entry.
+ */
+static int naive_disk_usage(const char *path, uint64_t &bytes, size_t &files, size_t &dirs)
+{
+    char child_path[256];
+    struct dirent *dir_ent;
+    struct stat entry_stat;
+    DIR *dir;
+    int ret_code = 0;
+
+    if ((dir = opendir(path)) == NULL) {
+        return -1;
+    }
+    while (ret_code == 0 && (dir_ent = pathutil::readdir_child(dir)) != NULL) {
+        pathutil::join_paths(child_path, sizeof(child_path), path, dir_ent->d_name);
+        if (stat(child_path, &entry_stat)) {
+            ret_code = -1;
+        } else if (S_ISDIR(entry_stat.st_mode)) {
+            dirs++;
+            ret_code = naive_disk_usage(child_path, bytes, files, dirs);
+        } else {
+            bytes += entry_stat.st_size;
+            files++;
+        }
+    }
+    closedir(dir);
+    return ret_code;
+}
+
+BENCH_CASE(bench_disk_usage)
+{
+    const int depth = 3, width = 4, files_per_dir = 8;
+    const unsigned long entries = tree_entries(depth, width, files_per_dir);
+    const size_t expected_files = entries / (files_per_dir + 1) * files_per_dir;
+    const size_t expected_dirs = entries / (files_per_dir + 1) - 1;
+    char path[256];
+    char buff[256];
+    const size_t n = ctx.iterations(100);
+    uint64_t bytes;
+    size_t files;
+    size_t dirs;
+
+    pathutil::join_paths(path, sizeof(path), ctx.work_dir(), "tree");
+    BENCH_CHECK(make_tree(path, depth, width, files_per_dir, 16) == 0);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        bytes = 0;
+        files = 0;
+        dirs = 0;
+        BENCH_CHECK(naive_disk_usage(path, bytes, files, dirs) == 0);
+        BENCH_CHECK(bytes == expected_files * 16 && files == expected_files && dirs == expected_dirs);
+    }
+    ctx.stop();
+    ctx.report("disk_usage_naive/d3_w4_f8", n * entries);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::disk_usage(path, &bytes, &files, &dirs, buff, sizeof(buff)) == 0);
+        BENCH_CHECK(bytes == expected_files * 16 && files == expected_files && dirs == expected_dirs);
+    }
+    ctx.stop();
+    ctx.report("disk_usage/d3_w4_f8", n * entries);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        pathutil::DiskUsageScanner scanner;
+        int ret_code;
+        BENCH_CHECK(scanner.start(path, buff, sizeof(buff)) == 0);
+        while ((ret_code = scanner.step(32)) > 0) {
+        }
+        BENCH_CHECK(ret_code == 0 && scanner.bytes() == expected_files * 16);
+    }
+    ctx.stop();
+    ctx.report("disk_usage_scanner/d3_w4_f8_step_32", n * entries);
+
+    BENCH_CHECK(pathutil::rmtree(path) == 0);
+}
+
+static int compare_name_ptr(const void *a, const void *b)
+{
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+BENCH_CASE(bench_scandir)
+{
+    enum { FILES = 128 };
+    static char names[FILES][32];
+    static uint64_t arena_buff[1024];
+    const char *sorted[FILES];
+    char dir_path[256];
+    char path[320];
+    const size_t n = ctx.iterations(200);
+
+    pathutil::join_paths(dir_path, sizeof(dir_path), ctx.work_dir(), "listing");
+    BENCH_CHECK(pathutil::makedirs(dir_path) == 0);
+    for (int i = 0; i < FILES; i++) {
+        snprintf(path, sizeof(path), "%s/file_%03i.dat", dir_path, (i * 37) % FILES);
+        BENCH_CHECK(pathutil::write_str(path, "hello") == 0);
+    }
+
+    // sorted listing with sizes, that is built around readdir_child
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        DIR *dir = opendir(dir_path);
+        struct dirent *dir_ent;
+        size_t count = 0;
+        off_t total_size = 0;
+        BENCH_CHECK(dir != NULL);
+        while ((dir_ent = pathutil::readdir_child(dir)) != NULL && count < FILES) {
+            strcpy(names[count], dir_ent->d_name);
+            sorted[count] = names[count];
+            count++;
+        }
+        closedir(dir);
+        qsort(sorted, count, sizeof(sorted[0]), compare_name_ptr);
+        for (size_t j = 0; j < count; j++) {
+            pathutil::PathInfo info;
+            pathutil::join_paths(path, sizeof(path), dir_path, sorted[j]);
+            BENCH_CHECK(pathutil::path_info(path, &info) == 0);
+            total_size += info.size;
+        }
+        BENCH_CHECK(count == FILES && total_size == FILES * 5);
+    }
+    ctx.stop();
+    ctx.report("listing_naive/128_files", n * FILES);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        pathutil::PathArena arena(arena_buff, sizeof(arena_buff));
+        pathutil::DirListing listing;
+        off_t total_size = 0;
+        BENCH_CHECK(pathutil::scandir(dir_path, listing, arena, pathutil::DIR_SORT_NAME) == 0);
+        for (size_t j = 0; j < listing.size(); j++) {
+            total_size += listing.info(j).size;
+        }
+        BENCH_CHECK(listing.size() == FILES && total_size == FILES * 5);
+    }
+    ctx.stop();
+    ctx.report("scandir/128_files", n * FILES);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        pathutil::PathArena arena(arena_buff, sizeof(arena_buff));
+        pathutil::DirListing listing;
+        BENCH_CHECK(pathutil::scandir(dir_path, listing, arena, pathutil::DIR_SORT_NAME) == 0);
+        BENCH_CHECK(listing.size() == FILES);
+    }
+    ctx.stop();
+    ctx.report("scandir/128_files_names_only", n * FILES);
+
+    BENCH_CHECK(pathutil::rmtree(dir_path) == 0);
+}
+
+static void bench_write_read_size(Context &ctx, const char *write_name, const char *read_name, size_t size)
+{
+    char path[256];
+    static uint8_t data[65536];
+    const size_t n = ctx.iterations(2000);
+
+    pathutil::join_paths(path, sizeof(path), ctx.work_dir(), "data.bin");
+    memset(data, 0x5A, size);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::write_data(path, data, size) == 0);
+    }
+    ctx.stop();
+    ctx.report(write_name, n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::read_data(path, data, sizeof(data)) == (int)size);
+    }
+    ctx.stop();
+    ctx.report(read_name, n);
+
+    BENCH_CHECK(remove(path) == 0);
+}
+
+BENCH_CASE(bench_write_read_data)
+{
+    bench_write_read_size(ctx, "write_data/64B", "read_data/64B", 64);
+    bench_write_read_size(ctx, "write_data/4KB", "read_data/4KB", 4096);
+    bench_write_read_size(ctx, "write_data/64KB", "read_data/64KB", 65536);
+}
+
+static int sum_chunk_callback(const uint8_t *data, size_t len, off_t offset, void *context)
+{
+    (void)offset;
+    for (size_t i = 0; i < len; i += 512) {
+        *(uint32_t *)context += data[i];
+    }
+    return 0;
+}
+
+BENCH_CASE(bench_read_chunks)
+{
+    const size_t file_size = 1 << 20;
+    const size_t n = ctx.iterations(50);
+    static uint8_t whole_buff[1 << 20];
+    static uint8_t chunk_buff[65536];
+    char path[256];
+    char name[64];
+    uint32_t expected_sum = 0;
+    uint32_t sum;
+
+    pathutil::join_paths(path, sizeof(path), ctx.work_dir(), "blob.bin");
+    for (size_t i = 0; i < file_size; i++) {
+        whole_buff[i] = (uint8_t)(i * 7);
+    }
+    BENCH_CHECK(pathutil::write_data(path, whole_buff, file_size) == 0);
+    sum_chunk_callback(whole_buff, file_size, 0, &expected_sum);
+
+    // baseline: the whole file in memory
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        sum = 0;
+        BENCH_CHECK(pathutil::read_data(path, whole_buff, file_size) == (int)file_size);
+        sum_chunk_callback(whole_buff, file_size, 0, &sum);
+        BENCH_CHECK(sum == expected_sum);
+    }
+    ctx.stop();
+    snprintf(name, sizeof(name), "read_data/1MB(%.2f GB/s)", (double)file_size * n / ctx.elapsed_ns());
+    ctx.report(name, n);
+
+    const size_t chunk_sizes[] = { 512, 4096, 65536 };
+    for (size_t c = 0; c < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); c++) {
+        ctx.start();
+        for (size_t i = 0; i < n; i++) {
+            sum = 0;
+            BENCH_CHECK(pathutil::read_chunks(path, chunk_buff, chunk_sizes[c], sum_chunk_callback, &sum) == 0);
+            BENCH_CHECK(sum == expected_sum);
+        }
+        ctx.stop();
+        snprintf(name, sizeof(name), "read_chunks/1MB_buf_%zu(%.2f GB/s)", chunk_sizes[c], (double)file_size * n / ctx.elapsed_ns());
+        ctx.report(name, n);
+    }
+
+    BENCH_CHECK(remove(path) == 0);
+}
+
+BENCH_CASE(bench_map_file)
+{
+    const size_t file_size = 1 << 20;
+    const size_t n = ctx.iterations(50);
+    static uint8_t whole_buff[1 << 20];
+    char path[256];
+    char name[64];
+    uint32_t expected_sum = 0;
+    uint32_t sum;
+
+    pathutil::join_paths(path, sizeof(path), ctx.work_dir(), "blob.bin");
+    for (size_t i = 0; i < file_size; i++) {
+        whole_buff[i] = (uint8_t)(i * 7);
+    }
+    BENCH_CHECK(pathutil::write_data(path, whole_buff, file_size) == 0);
+    sum_chunk_callback(whole_buff, file_size, 0, &expected_sum);
+
+    // baseline: copy of the file in a caller buffer
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        sum = 0;
+        BENCH_CHECK(pathutil::read_data(path, whole_buff, file_size) == (int)file_size);
+        sum_chunk_callback(whole_buff, file_size, 0, &sum);
+        BENCH_CHECK(sum == expected_sum);
+    }
+    ctx.stop();
+    snprintf(name, sizeof(name), "read_data/1MB(%.2f GB/s)", (double)file_size * n / ctx.elapsed_ns());
+    ctx.report(name, n);
+
+    const pathutil::MapAccess modes[] = { pathutil::MAP_ACCESS_NORMAL, pathutil::MAP_ACCESS_SEQUENTIAL, pathutil::MAP_ACCESS_RANDOM };
+    const char *const mode_names[] = { "normal", "seq", "random" };
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        ctx.start();
+        for (size_t i = 0; i < n; i++) {
+            pathutil::MappedFile file = pathutil::map_file(path, modes[m]);
+            BENCH_CHECK(file.is_open() && file.size() == file_size);
+            sum = 0;
+            sum_chunk_callback(file.data(), file.size(), 0, &sum);
+            BENCH_CHECK(sum == expected_sum);
+        }
+        ctx.stop();
+        snprintf(name, sizeof(name), "map_file/1MB_%s(%.2f GB/s)", mode_names[m], (double)file_size * n / ctx.elapsed_ns());
+        ctx.report(name, n);
+    }
+
+    BENCH_CHECK(remove(path) == 0);
+}
+
+BENCH_CASE(bench_stat_batch)
+{
+    enum { DIRS = 8, FILES_PER_DIR = 32, PATHS = DIRS * FILES_PER_DIR };
+    static char path_data[PATHS][320];
+    static pathutil::PathInfo infos[PATHS];
+    const char *paths[PATHS];
+    char root[256];
+    const size_t n = ctx.iterations(500);
+
+    // manifest of existing files and several missing ones
+    pathutil::join_paths(root, sizeof(root), ctx.work_dir(), "manifest");
+    for (int i = 0; i < PATHS; i++) {
+        snprintf(path_data[i], sizeof(path_data[i]), "%s/dir_%i/file_%i.dat", root, i % DIRS, i / DIRS);
+        paths[i] = path_data[i];
+        if (i % 16 != 0) {
+            char dir_path[320];
+            strcpy(dir_path, paths[i]);
+            *strrchr(dir_path, '/') = '\0';
+            BENCH_CHECK(pathutil::makedirs(dir_path, 0777, true) == 0);
+            BENCH_CHECK(pathutil::write_str(paths[i], "") == 0);
+        }
+    }
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        size_t exists_num = 0;
+        for (int j = 0; j < PATHS; j++) {
+            exists_num += pathutil::exists(paths[j]);
+        }
+        BENCH_CHECK(exists_num == PATHS - PATHS / 16);
+    }
+    ctx.stop();
+    ctx.report("exists_loop/256_paths", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::stat_batch(paths, PATHS, infos) == PATHS - PATHS / 16);
+    }
+    ctx.stop();
+    ctx.report("stat_batch/256_paths", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::stat_batch(paths, PATHS, infos, true) == PATHS - PATHS / 16);
+    }
+    ctx.stop();
+    ctx.report("stat_batch/256_paths_type_only", n);
+
+    BENCH_CHECK(pathutil::rmtree(root) == 0);
+}
+
+BENCH_CASE(bench_predicates)
+{
+    char file_path[256];
+    char missing_path[256];
+    const size_t n = ctx.iterations(50000);
+
+    pathutil::join_paths(file_path, sizeof(file_path), ctx.work_dir(), "file.txt");
+    pathutil::join_paths(missing_path, sizeof(missing_path), ctx.work_dir(), "missing.txt");
+    BENCH_CHECK(pathutil::write_str(file_path, "hello world") == 0);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::isfile(file_path));
+    }
+    ctx.stop();
+    ctx.report("isfile/existing", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(!pathutil::exists(missing_path));
+    }
+    ctx.stop();
+    ctx.report("exists/missing", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::getsize(file_path) == 11);
+    }
+    ctx.stop();
+    ctx.report("getsize/file", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::isfile(file_path) && pathutil::getsize(file_path) == 11);
+    }
+    ctx.stop();
+    ctx.report("isfile+getsize/file", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        pathutil::PathInfo info;
+        BENCH_CHECK(pathutil::path_info(file_path, &info) == 0 && info.type == pathutil::PATH_TYPE_FILE && info.size == 11);
+    }
+    ctx.stop();
+    ctx.report("path_info/file", n);
+
+    BENCH_CHECK(pathutil::stat_cache_enable(64) == 0);
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::isfile(file_path));
+    }
+    ctx.stop();
+    ctx.report("isfile/existing_cached", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(!pathutil::exists(missing_path));
+    }
+    ctx.stop();
+    ctx.report("exists/missing_cached", n);
+    pathutil::stat_cache_disable();
+
+    BENCH_CHECK(remove(file_path) == 0);
+    errno = 0;
+}
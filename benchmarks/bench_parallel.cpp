@@ -0,0 +1,181 @@
+/**
+ * Benchmarks of the multithreaded functions.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "pathutil.h"
+
+using namespace bench;
+
+#if PATHUTIL_USE_THREADS
+
+static void bench_rmtree_threads(Context &ctx, int depth, int width, int files, size_t nthreads)
+{
+    char path[256];
+    char name[64];
+    const size_t n = ctx.iterations(20);
+    const unsigned long entries = tree_entries(depth, width, files);
+    int ret_code;
+
+    pathutil::join_paths(path, sizeof(path), ctx.work_dir(), "tree");
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(make_tree(path, depth, width, files, 16) == 0);
+        ctx.start();
+        if (nthreads == 0) {
+            ret_code = pathutil::rmtree(path);
+        } else {
+            ret_code = pathutil::rmtree_parallel(path, nthreads);
+        }
+        ctx.stop();
+        BENCH_CHECK(ret_code == 0);
+    }
+    if (nthreads == 0) {
+        snprintf(name, sizeof(name), "rmtree/d%i_w%i_f%i(per entry)", depth, width, files);
+    } else {
+        snprintf(name, sizeof(name), "rmtree_parallel/d%i_w%i_f%i_t%zu(per entry)", depth, width, files, nthreads);
+    }
+    ctx.report(name, n * entries);
+}
+
+BENCH_CASE(bench_rmtree_parallel)
+{
+    const size_t threads[] = { 1, 2, 4, 8, 16 };
+    const int depth = ctx.quick() ? 2 : 3;
+
+    // single thread baseline
+    bench_rmtree_threads(ctx, depth, 8, 16, 0);
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        bench_rmtree_threads(ctx, depth, 8, 16, threads[i]);
+    }
+}
+
+BENCH_CASE(bench_disk_usage_parallel)
+{
+    const size_t threads[] = { 1, 2, 4, 8 };
+    const int depth = ctx.quick() ? 2 : 3;
+    const unsigned long entries = tree_entries(depth, 8, 16);
+    const size_t n = ctx.iterations(50);
+    char path[256];
+    char name[64];
+    uint64_t bytes;
+    uint64_t expected_bytes;
+    size_t files;
+    size_t dirs;
+
+    pathutil::join_paths(path, sizeof(path), ctx.work_dir(), "tree");
+    BENCH_CHECK(make_tree(path, depth, 8, 16, 16) == 0);
+
+    // single thread baseline
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::disk_usage(path, &expected_bytes) == 0);
+    }
+    ctx.stop();
+    snprintf(name, sizeof(name), "disk_usage/d%i_w8_f16(per entry)", depth);
+    ctx.report(name, n * entries);
+
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        ctx.start();
+        for (size_t j = 0; j < n; j++) {
+            BENCH_CHECK(pathutil::disk_usage_parallel(path, &bytes, &files, &dirs, threads[i]) == 0);
+            BENCH_CHECK(bytes == expected_bytes && files + dirs + 1 == entries);
+        }
+        ctx.stop();
+        snprintf(name, sizeof(name), "disk_usage_parallel/d%i_w8_f16_t%zu(per entry)", depth, threads[i]);
+        ctx.report(name, n * entries);
+    }
+
+    BENCH_CHECK(pathutil::rmtree(path) == 0);
+}
+
+/**
+ * Create packed buffer of the manifest paths, where every fourth path isn't normalized.
+ */
+static size_t make_manifest(char *buff, size_t *offsets, size_t count)
+{
+    size_t pos = 0;
+    for (size_t i = 0; i < count; i++) {
+        offsets[i] = pos;
+        if (i % 4 == 0) {
+            pos += sprintf(buff + pos, "/test_bd/data//dir_%02u/./sub_%03u/../sub_%03u/file_%06u.bin/", (unsigned)(i % 64),
+                           (unsigned)(i % 1000), (unsigned)(i % 1000), (unsigned)i) + 1;
+        } else {
+            pos += sprintf(buff + pos, "/test_bd/data/dir_%02u/sub_%03u/file_%06u.bin", (unsigned)(i % 64), (unsigned)(i % 1000), (unsigned)i) + 1;
+        }
+    }
+    return pos;
+}
+
+static void bench_normpath_batch_threads(Context &ctx, const char *origin_buff, char *buff, size_t buff_size,
+                                         const size_t *offsets, size_t *lengths, size_t count, size_t nthreads)
+{
+    char name[64];
+    const size_t n = ctx.iterations(100) < 2 ? 2 : ctx.iterations(100);
+    uint64_t elapsed_ns;
+
+    for (size_t i = 0; i < n; i++) {
+        memcpy(buff, origin_buff, buff_size);
+        ctx.start();
+        if (nthreads == 0) {
+            pathutil::normpath_batch(buff, offsets, count, lengths);
+        } else {
+            pathutil::normpath_batch_parallel(buff, offsets, count, lengths, nthreads);
+        }
+        ctx.stop();
+    }
+    elapsed_ns = ctx.elapsed_ns();
+    if (nthreads == 0) {
+        snprintf(name, sizeof(name), "normpath_batch(%.2f GB/s)", (double)buff_size * n / elapsed_ns);
+    } else {
+        snprintf(name, sizeof(name), "normpath_batch_parallel/t%zu(%.2f GB/s)", nthreads, (double)buff_size * n / elapsed_ns);
+    }
+    ctx.report(name, n * count);
+}
+
+BENCH_CASE(bench_normpath_batch)
+{
+    const size_t threads[] = { 1, 2, 4, 8 };
+    const size_t count = ctx.quick() ? 20000 : 1000000;
+    const size_t path_max = 80;
+    char *origin_buff = new char[count * path_max];
+    char *buff = new char[count * path_max];
+    size_t *offsets = new size_t[count];
+    size_t *lengths = new size_t[count];
+    size_t buff_size = make_manifest(origin_buff, offsets, count);
+    const size_t n = ctx.iterations(100) < 2 ? 2 : ctx.iterations(100);
+    char name[64];
+
+    // baseline: separate normpath and strlen calls
+    for (size_t i = 0; i < n; i++) {
+        memcpy(buff, origin_buff, buff_size);
+        ctx.start();
+        for (size_t j = 0; j < count; j++) {
+            pathutil::normpath(buff + offsets[j]);
+            lengths[j] = strlen(buff + offsets[j]);
+        }
+        ctx.stop();
+    }
+    snprintf(name, sizeof(name), "normpath_loop(%.2f GB/s)", (double)buff_size * n / ctx.elapsed_ns());
+    ctx.report(name, n * count);
+
+    bench_normpath_batch_threads(ctx, origin_buff, buff, buff_size, offsets, lengths, count, 0);
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        bench_normpath_batch_threads(ctx, origin_buff, buff, buff_size, offsets, lengths, count, threads[i]);
+        // results should be the same as scalar normpath gives
+        for (size_t j = 0; j < count; j += 97) {
+            char path[path_max];
+            strcpy(path, origin_buff + offsets[j]);
+            pathutil::normpath(path);
+            BENCH_CHECK(strcmp(path, buff + offsets[j]) == 0 && strlen(path) == lengths[j]);
+        }
+    }
+
+    delete[] lengths;
+    delete[] offsets;
+    delete[] buff;
+    delete[] origin_buff;
+}
+
+#endif
@@ -0,0 +1,587 @@
+/**
+ * Benchmarks of the path manipulation functions.
+ */
+#include <fnmatch.h>
+#include <string.h>
+
+#include "bench.h"
+#include "pathutil.h"
+
+using namespace bench;
+
+static const char *const CANONICAL_PATH = "/test_bd/config/device/settings.txt";
+static const char *const MESSY_PATH = "/test_bd//config/./device/../device/settings.txt/";
+static const char *const LONG_PATH = "/test_bd/some/very/long/path/with/a/lot/of/components/to/check/scan/speed/file.bin";
+
+static const char *const SHORT_PATH = "/fs/a.txt";
+// hidden files look like "/./" for the vectorized pre-scan, so they are checked precisely
+static const char *const HIDDEN_PATH = "/.test_bd/.config/.device/.cache/.local/.share/.settings/.txt";
+
+static void bench_normpath_input(Context &ctx, const char *name, const char *input)
+{
+    char buf[1024];
+    const size_t input_size = strlen(input) + 1;
+    const size_t n = ctx.iterations(2000000);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        memcpy(buf, input, input_size);
+        pathutil::normpath(buf);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report(name, n);
+}
+
+static void bench_is_normalized_input(Context &ctx, const char *name, const char *input, bool expected)
+{
+    const size_t n = ctx.iterations(2000000);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::is_normalized(input) == expected);
+        do_not_optimize(input);
+    }
+    ctx.stop();
+    ctx.report(name, n);
+}
+
+/**
+ * Create path of the \p len length from repeated components.
+ */
+static void make_long_path(char *buf, size_t len, const char *tail)
+{
+    size_t tail_len = strlen(tail);
+    for (size_t i = 0; i < len - tail_len; i++) {
+        buf[i] = i % 8 == 0 ? '/' : 'a' + i % 8;
+    }
+    strcpy(buf + len - tail_len, tail);
+}
+
+BENCH_CASE(bench_normpath)
+{
+    char huge_path[1000];
+    char huge_messy_path[1000];
+
+    make_long_path(huge_path, 960, "/end");
+    make_long_path(huge_messy_path, 960, "//end");
+
+    bench_normpath_input(ctx, "normpath/short", SHORT_PATH);
+    bench_normpath_input(ctx, "normpath/canonical", CANONICAL_PATH);
+    bench_normpath_input(ctx, "normpath/messy", MESSY_PATH);
+    bench_normpath_input(ctx, "normpath/long", LONG_PATH);
+    bench_normpath_input(ctx, "normpath/hidden", HIDDEN_PATH);
+    bench_normpath_input(ctx, "normpath/960B", huge_path);
+    bench_normpath_input(ctx, "normpath/960B_messy_tail", huge_messy_path);
+
+    bench_is_normalized_input(ctx, "is_normalized/short", SHORT_PATH, true);
+    bench_is_normalized_input(ctx, "is_normalized/canonical", CANONICAL_PATH, true);
+    bench_is_normalized_input(ctx, "is_normalized/messy", MESSY_PATH, false);
+    bench_is_normalized_input(ctx, "is_normalized/long", LONG_PATH, true);
+    bench_is_normalized_input(ctx, "is_normalized/hidden", HIDDEN_PATH, true);
+    bench_is_normalized_input(ctx, "is_normalized/960B", huge_path, true);
+    bench_is_normalized_input(ctx, "is_normalized/960B_messy_tail", huge_messy_path, false);
+}
+
+BENCH_CASE(bench_join_paths)
+{
+    char buf[256];
+    const size_t n = ctx.iterations(2000000);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::join_paths(buf, sizeof(buf), "/test_bd/config", "device/settings.txt") == 0);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("join_paths/checked", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        pathutil::join_paths(buf, "/test_bd/config", "device/settings.txt");
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("join_paths/unchecked", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::join_paths(buf, sizeof(buf), "/test_bd/config", "/abs/settings.txt") == 0);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("join_paths/absolute_right", n);
+}
+
+BENCH_CASE(bench_join_paths_multi)
+{
+    char buf[256];
+    const char *parts[] = {"/test_bd", "dev", "device_0042", "cfg", "settings.txt"};
+    const size_t n = ctx.iterations(2000000);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::join_paths(buf, sizeof(buf), "/test_bd", "dev") == 0);
+        BENCH_CHECK(pathutil::append_path(buf, sizeof(buf), "device_0042") == 0);
+        BENCH_CHECK(pathutil::append_path(buf, sizeof(buf), "cfg") == 0);
+        BENCH_CHECK(pathutil::append_path(buf, sizeof(buf), "settings.txt") == 0);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("join_5_parts/append_chain", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::join_paths(buf, sizeof(buf), "/test_bd", "dev", "device_0042", "cfg", "settings.txt") == 0);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("join_5_parts/variadic", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::join_paths(buf, sizeof(buf), parts, sizeof(parts) / sizeof(parts[0])) == 0);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("join_5_parts/array", n);
+}
+
+BENCH_CASE(bench_append_path)
+{
+    char buf[256];
+    const size_t n = ctx.iterations(2000000);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        strcpy(buf, "/test_bd/config");
+        BENCH_CHECK(pathutil::append_path(buf, sizeof(buf), "device/settings.txt") == 0);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("append_path/checked", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        strcpy(buf, "/test_bd/config");
+        pathutil::append_path(buf, "device/settings.txt");
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("append_path/unchecked", n);
+}
+
+BENCH_CASE(bench_dirname_basename)
+{
+    char buf[256];
+    const size_t n = ctx.iterations(2000000);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::dirname(buf, sizeof(buf), LONG_PATH) == 0);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("dirname/long", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::basename(buf, sizeof(buf), LONG_PATH) == 0);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("basename/long", n);
+}
+
+BENCH_CASE(bench_path_components)
+{
+    char buf[256];
+    char name[256];
+    size_t parts_len;
+    const size_t n = ctx.iterations(1000000);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        parts_len = 0;
+        strcpy(buf, LONG_PATH);
+        while (buf[0] != '\0' && strcmp(buf, "/") != 0) {
+            BENCH_CHECK(pathutil::basename(name, sizeof(name), buf) == 0);
+            parts_len += strlen(name);
+            pathutil::dirname(buf);
+        }
+        do_not_optimize(parts_len);
+    }
+    ctx.stop();
+    ctx.report("components/dirname_basename_loop", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        parts_len = 0;
+        for (pathutil::PathView part : pathutil::PathView(LONG_PATH).reversed()) {
+            parts_len += part.size();
+        }
+        do_not_optimize(parts_len);
+    }
+    ctx.stop();
+    ctx.report("components/path_view_reversed", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        parts_len = 0;
+        for (pathutil::PathView part : pathutil::PathView(LONG_PATH)) {
+            parts_len += part.size();
+        }
+        do_not_optimize(parts_len);
+    }
+    ctx.stop();
+    ctx.report("components/path_view", n);
+}
+
+/**
+ * relpath implementation with the dirname loop: both paths are normalized in temporary buffers and start directory
+ * is shortened until it becomes a prefix of the path.
+ */
+static int naive_relpath(char *output_path, size_t n, const char *path, const char *start)
+{
+    char path_buf[256];
+    char start_buf[256];
+    size_t start_len;
+    size_t ups = 0;
+    const char *tail;
+
+    strcpy(path_buf, path);
+    strcpy(start_buf, start);
+    pathutil::normpath(path_buf);
+    pathutil::normpath(start_buf);
+    while (true) {
+        start_len = strlen(start_buf);
+        if (strncmp(path_buf, start_buf, start_len) == 0 && (path_buf[start_len] == '/' || path_buf[start_len] == '\0' || start_len == 1)) {
+            break;
+        }
+        pathutil::dirname(start_buf);
+        ups++;
+    }
+    tail = path_buf + start_len;
+    tail += *tail == '/' ? 1 : 0;
+    output_path[0] = '\0';
+    for (size_t i = 0; i < ups; i++) {
+        if (pathutil::append_path(output_path, n, "..")) {
+            return -1;
+        }
+    }
+    return pathutil::append_path(output_path, n, *tail == '\0' && ups == 0 ? "." : tail);
+}
+
+/**
+ * commonpath implementation with the dirname loop.
+ */
+static int naive_commonpath(char *output_path, size_t n, const char *const *paths, size_t count)
+{
+    char path_buf[256];
+    size_t common_len;
+
+    if (strlen(paths[0]) + 1 > n) {
+        return -1;
+    }
+    strcpy(output_path, paths[0]);
+    pathutil::normpath(output_path);
+    for (size_t i = 1; i < count; i++) {
+        strcpy(path_buf, paths[i]);
+        pathutil::normpath(path_buf);
+        while (true) {
+            common_len = strlen(output_path);
+            if (strncmp(path_buf, output_path, common_len) == 0 && (path_buf[common_len] == '/' || path_buf[common_len] == '\0' || common_len == 1)) {
+                break;
+            }
+            pathutil::dirname(output_path);
+        }
+    }
+    return 0;
+}
+
+BENCH_CASE(bench_relpath)
+{
+    char buf[256];
+    const char *start = "/test_bd/some/very/long/path/with/other/components";
+    const char *paths[] = {LONG_PATH, "/test_bd/some/very/long/path/with/a/lot/of/other/file.bin",
+                           "/test_bd/some/very/long/path/with/a/few/components", "/test_bd/some/very/long/path/file.bin"
+                          };
+    const size_t n = ctx.iterations(1000000);
+
+    BENCH_CHECK(naive_relpath(buf, sizeof(buf), LONG_PATH, start) == 0);
+    BENCH_CHECK(strcmp(buf, "../../a/lot/of/components/to/check/scan/speed/file.bin") == 0);
+    BENCH_CHECK(pathutil::relpath(buf, sizeof(buf), LONG_PATH, start) == 0);
+    BENCH_CHECK(strcmp(buf, "../../a/lot/of/components/to/check/scan/speed/file.bin") == 0);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(naive_relpath(buf, sizeof(buf), LONG_PATH, start) == 0);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("relpath/naive", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::relpath(buf, sizeof(buf), LONG_PATH, start) == 0);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("relpath/single_pass", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(naive_relpath(buf, sizeof(buf), MESSY_PATH, start) == 0);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("relpath/naive_messy", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::relpath(buf, sizeof(buf), MESSY_PATH, start) == 0);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("relpath/single_pass_messy", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(naive_commonpath(buf, sizeof(buf), paths, 4) == 0);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("commonpath/naive_4", n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::commonpath(buf, sizeof(buf), paths, 4) == 0);
+        do_not_optimize(buf);
+    }
+    ctx.stop();
+    ctx.report("commonpath/single_pass_4", n);
+    BENCH_CHECK(strcmp(buf, "/test_bd/some/very/long/path") == 0);
+}
+
+static uint32_t fnv_hash(const char *path)
+{
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *pos = (const unsigned char *)path; *pos != '\0'; pos++) {
+        hash ^= *pos;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void bench_path_hash_input(Context &ctx, const char *name, const char *path, const char *other_path)
+{
+    char buf[256];
+    char other_buf[256];
+    char report_name[64];
+    const size_t n = ctx.iterations(1000000);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        strcpy(buf, path);
+        pathutil::normpath(buf);
+        do_not_optimize(fnv_hash(buf));
+    }
+    ctx.stop();
+    snprintf(report_name, sizeof(report_name), "path_hash/%s_normpath_fnv", name);
+    ctx.report(report_name, n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        do_not_optimize(pathutil::path_hash(path));
+    }
+    ctx.stop();
+    snprintf(report_name, sizeof(report_name), "path_hash/%s", name);
+    ctx.report(report_name, n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        strcpy(buf, path);
+        strcpy(other_buf, other_path);
+        pathutil::normpath(buf);
+        pathutil::normpath(other_buf);
+        BENCH_CHECK(strcmp(buf, other_buf) == 0);
+    }
+    ctx.stop();
+    snprintf(report_name, sizeof(report_name), "path_equal/%s_normpath_strcmp", name);
+    ctx.report(report_name, n);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::path_equal(path, other_path));
+    }
+    ctx.stop();
+    snprintf(report_name, sizeof(report_name), "path_equal/%s", name);
+    ctx.report(report_name, n);
+}
+
+BENCH_CASE(bench_path_hash)
+{
+    bench_path_hash_input(ctx, "canonical", CANONICAL_PATH, CANONICAL_PATH);
+    bench_path_hash_input(ctx, "long", LONG_PATH, LONG_PATH);
+    bench_path_hash_input(ctx, "messy", MESSY_PATH, CANONICAL_PATH);
+}
+
+static int count_path_callback(const char *path, void *context)
+{
+    (void)path;
+    (*(size_t *)context)++;
+    return 0;
+}
+
+BENCH_CASE(bench_path_trie)
+{
+    const size_t paths_num = 10000;
+    const size_t path_size = 64;
+    const size_t arena_size = 512 * 1024;
+    uint8_t *arena_buff = new uint8_t[arena_size];
+    char *paths = new char[paths_num * path_size];
+    char path[128];
+    char report_name[64];
+    size_t packed_size = 0;
+    size_t count = 0;
+    const size_t n = ctx.iterations(20);
+    pathutil::PathArena arena(arena_buff, arena_size);
+    pathutil::PathTrie trie(arena);
+
+    for (size_t j = 0; j < paths_num; j++) {
+        snprintf(paths + j * path_size, path_size, "/test_bd/data/dir_%02u/sub_%03u/file_%05u.bin", (unsigned)(j % 16), (unsigned)(j % 512), (unsigned)j);
+        packed_size += strlen(paths + j * path_size) + 1;
+    }
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        trie.clear();
+        arena.reset();
+        for (size_t j = 0; j < paths_num; j++) {
+            BENCH_CHECK(trie.insert(paths + j * path_size) == 0);
+        }
+    }
+    ctx.stop();
+    // compare memory usage with packed null terminated strings
+    snprintf(report_name, sizeof(report_name), "path_trie/insert(%uK, strings=%uK)", (unsigned)(trie.memory_used() / 1024), (unsigned)(packed_size / 1024));
+    ctx.report(report_name, n * paths_num);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < paths_num; j++) {
+            BENCH_CHECK(trie.lookup(paths + j * path_size) == 0);
+        }
+    }
+    ctx.stop();
+    ctx.report("path_trie/lookup(per path)", n * paths_num);
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        count = 0;
+        BENCH_CHECK(trie.enumerate("/test_bd/data", path, sizeof(path), count_path_callback, &count) == 0);
+        BENCH_CHECK(count == paths_num);
+    }
+    ctx.stop();
+    ctx.report("path_trie/enumerate(per path)", n * paths_num);
+
+    delete[] paths;
+    delete[] arena_buff;
+}
+
+static const char *const GLOB_NAMES[] = {
+    "boot.log", "boot.log.1", "cfg_01.bin", "cfg_1.bin", "settings.txt", "firmware_v2.bin", "cfg_ab.bin", "system.log",
+};
+static const size_t GLOB_NAMES_NUM = sizeof(GLOB_NAMES) / sizeof(GLOB_NAMES[0]);
+
+static void bench_glob_pattern(Context &ctx, const char *name, const char *pattern, size_t expected)
+{
+    char report_name[64];
+    const size_t n = ctx.iterations(200000);
+    pathutil::GlobPattern glob;
+    size_t matched = 0;
+
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < GLOB_NAMES_NUM; j++) {
+            matched += ::fnmatch(pattern, GLOB_NAMES[j], FNM_PATHNAME) == 0 ? 1 : 0;
+        }
+    }
+    ctx.stop();
+    snprintf(report_name, sizeof(report_name), "fnmatch/%s_libc", name);
+    ctx.report(report_name, n * GLOB_NAMES_NUM);
+    BENCH_CHECK(matched == expected * n);
+
+    matched = 0;
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < GLOB_NAMES_NUM; j++) {
+            matched += pathutil::fnmatch(pattern, GLOB_NAMES[j]) ? 1 : 0;
+        }
+    }
+    ctx.stop();
+    snprintf(report_name, sizeof(report_name), "fnmatch/%s", name);
+    ctx.report(report_name, n * GLOB_NAMES_NUM);
+    BENCH_CHECK(matched == expected * n);
+
+    matched = 0;
+    BENCH_CHECK(glob.compile(pattern) == 0);
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < GLOB_NAMES_NUM; j++) {
+            matched += glob.match(GLOB_NAMES[j]) ? 1 : 0;
+        }
+    }
+    ctx.stop();
+    snprintf(report_name, sizeof(report_name), "glob_pattern/%s", name);
+    ctx.report(report_name, n * GLOB_NAMES_NUM);
+    BENCH_CHECK(matched == expected * n);
+}
+
+BENCH_CASE(bench_glob)
+{
+    bench_glob_pattern(ctx, "suffix", "*.log", 2);
+    bench_glob_pattern(ctx, "question", "cfg_??.bin", 2);
+    bench_glob_pattern(ctx, "class", "*_[0-9]*.bin", 2);
+    bench_glob_pattern(ctx, "literal", "settings.txt", 1);
+}
+
+BENCH_CASE(bench_path_buffer)
+{
+    static const char *const names[] = {"config", "device", "settings", "cache", "logs", "data"};
+    const size_t names_num = sizeof(names) / sizeof(names[0]);
+    char buf[256];
+    size_t buf_len;
+    pathutil::PathBuffer<256> path;
+    const size_t n = ctx.iterations(2000000);
+
+    // descend into directory and return back like tree traversal does
+    strcpy(buf, LONG_PATH);
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::append_path(buf, sizeof(buf), names[i % names_num]) == 0);
+        do_not_optimize(buf);
+        pathutil::dirname(buf);
+    }
+    ctx.stop();
+    ctx.report("traversal/append_path+dirname", n);
+
+    buf_len = strlen(buf);
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        BENCH_CHECK(pathutil::append_path(buf, sizeof(buf), names[i % names_num]) == 0);
+        do_not_optimize(buf);
+        buf[buf_len] = '\0';
+    }
+    ctx.stop();
+    ctx.report("traversal/append_path+truncate", n);
+
+    BENCH_CHECK(path.assign(LONG_PATH) == 0);
+    ctx.start();
+    for (size_t i = 0; i < n; i++) {
+        pathutil::PathBufferBase::ScopedPush push(path, names[i % names_num]);
+        BENCH_CHECK(push.error() == 0);
+        do_not_optimize(path.c_str());
+    }
+    ctx.stop();
+    ctx.report("traversal/path_buffer_push", n);
+}
@@ -0,0 +1,200 @@
+/**
+ * Counters of the file system calls.
+ *
+ * The executable should be linked with "-Wl,--wrap=<function>" option for each wrapped function,
+ * so all calls of the library are redirected to the "__wrap_<function>" implementations below.
+ */
+#include "bench.h"
+
+#ifdef BENCH_WRAP_SYSCALLS
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+using namespace bench;
+
+const bool bench::syscall_counters_enabled = true;
+
+extern "C" {
+
+int __real_stat(const char *path, struct stat *buf);
+int __real_lstat(const char *path, struct stat *buf);
+int __real_fstat(int fd, struct stat *buf);
+int __real_mkdir(const char *path, mode_t mode);
+int __real_remove(const char *path);
+DIR *__real_opendir(const char *path);
+struct dirent *__real_readdir(DIR *dirp);
+int __real_closedir(DIR *dirp);
+int __real_open(const char *path, int flags, ...);
+ssize_t __real_read(int fd, void *buf, size_t count);
+ssize_t __real_write(int fd, const void *buf, size_t count);
+off_t __real_lseek(int fd, off_t offset, int whence);
+int __real_close(int fd);
+int __real_openat(int dir_fd, const char *path, int flags, ...);
+DIR *__real_fdopendir(int fd);
+int __real_fstatat(int dir_fd, const char *path, struct stat *buf, int flags);
+int __real_mkdirat(int dir_fd, const char *path, mode_t mode);
+int __real_unlinkat(int dir_fd, const char *path, int flags);
+int __real_rmdir(const char *path);
+void *__real_mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset);
+int __real_munmap(void *addr, size_t length);
+int __real_madvise(void *addr, size_t length, int advice);
+
+int __wrap_stat(const char *path, struct stat *buf)
+{
+    syscall_counters[SYSCALL_STAT].fetch_add(1, std::memory_order_relaxed);
+    return __real_stat(path, buf);
+}
+
+int __wrap_lstat(const char *path, struct stat *buf)
+{
+    syscall_counters[SYSCALL_LSTAT].fetch_add(1, std::memory_order_relaxed);
+    return __real_lstat(path, buf);
+}
+
+int __wrap_fstat(int fd, struct stat *buf)
+{
+    syscall_counters[SYSCALL_FSTAT].fetch_add(1, std::memory_order_relaxed);
+    return __real_fstat(fd, buf);
+}
+
+int __wrap_mkdir(const char *path, mode_t mode)
+{
+    syscall_counters[SYSCALL_MKDIR].fetch_add(1, std::memory_order_relaxed);
+    return __real_mkdir(path, mode);
+}
+
+int __wrap_remove(const char *path)
+{
+    syscall_counters[SYSCALL_REMOVE].fetch_add(1, std::memory_order_relaxed);
+    return __real_remove(path);
+}
+
+DIR *__wrap_opendir(const char *path)
+{
+    syscall_counters[SYSCALL_OPENDIR].fetch_add(1, std::memory_order_relaxed);
+    return __real_opendir(path);
+}
+
+struct dirent *__wrap_readdir(DIR *dirp)
+{
+    syscall_counters[SYSCALL_READDIR].fetch_add(1, std::memory_order_relaxed);
+    return __real_readdir(dirp);
+}
+
+int __wrap_closedir(DIR *dirp)
+{
+    syscall_counters[SYSCALL_CLOSEDIR].fetch_add(1, std::memory_order_relaxed);
+    return __real_closedir(dirp);
+}
+
+int __wrap_open(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+    if (flags & O_CREAT) {
+        va_list args;
+        va_start(args, flags);
+        mode = va_arg(args, int);
+        va_end(args);
+    }
+    syscall_counters[SYSCALL_OPEN].fetch_add(1, std::memory_order_relaxed);
+    return __real_open(path, flags, mode);
+}
+
+ssize_t __wrap_read(int fd, void *buf, size_t count)
+{
+    syscall_counters[SYSCALL_READ].fetch_add(1, std::memory_order_relaxed);
+    return __real_read(fd, buf, count);
+}
+
+ssize_t __wrap_write(int fd, const void *buf, size_t count)
+{
+    syscall_counters[SYSCALL_WRITE].fetch_add(1, std::memory_order_relaxed);
+    return __real_write(fd, buf, count);
+}
+
+off_t __wrap_lseek(int fd, off_t offset, int whence)
+{
+    syscall_counters[SYSCALL_LSEEK].fetch_add(1, std::memory_order_relaxed);
+    return __real_lseek(fd, offset, whence);
+}
+
+int __wrap_close(int fd)
+{
+    syscall_counters[SYSCALL_CLOSE].fetch_add(1, std::memory_order_relaxed);
+    return __real_close(fd);
+}
+
+int __wrap_openat(int dir_fd, const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+    if (flags & O_CREAT) {
+        va_list args;
+        va_start(args, flags);
+        mode = va_arg(args, int);
+        va_end(args);
+    }
+    syscall_counters[SYSCALL_OPENAT].fetch_add(1, std::memory_order_relaxed);
+    return __real_openat(dir_fd, path, flags, mode);
+}
+
+DIR *__wrap_fdopendir(int fd)
+{
+    syscall_counters[SYSCALL_FDOPENDIR].fetch_add(1, std::memory_order_relaxed);
+    return __real_fdopendir(fd);
+}
+
+int __wrap_fstatat(int dir_fd, const char *path, struct stat *buf, int flags)
+{
+    syscall_counters[SYSCALL_FSTATAT].fetch_add(1, std::memory_order_relaxed);
+    return __real_fstatat(dir_fd, path, buf, flags);
+}
+
+int __wrap_mkdirat(int dir_fd, const char *path, mode_t mode)
+{
+    syscall_counters[SYSCALL_MKDIRAT].fetch_add(1, std::memory_order_relaxed);
+    return __real_mkdirat(dir_fd, path, mode);
+}
+
+int __wrap_unlinkat(int dir_fd, const char *path, int flags)
+{
+    syscall_counters[SYSCALL_UNLINKAT].fetch_add(1, std::memory_order_relaxed);
+    return __real_unlinkat(dir_fd, path, flags);
+}
+
+int __wrap_rmdir(const char *path)
+{
+    syscall_counters[SYSCALL_RMDIR].fetch_add(1, std::memory_order_relaxed);
+    return __real_rmdir(path);
+}
+
+void *__wrap_mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset)
+{
+    syscall_counters[SYSCALL_MMAP].fetch_add(1, std::memory_order_relaxed);
+    return __real_mmap(addr, length, prot, flags, fd, offset);
+}
+
+int __wrap_munmap(void *addr, size_t length)
+{
+    syscall_counters[SYSCALL_MUNMAP].fetch_add(1, std::memory_order_relaxed);
+    return __real_munmap(addr, length);
+}
+
+int __wrap_madvise(void *addr, size_t length, int advice)
+{
+    syscall_counters[SYSCALL_MADVISE].fetch_add(1, std::memory_order_relaxed);
+    return __real_madvise(addr, length, advice);
+}
+}
+
+#else
+
+const bool bench::syscall_counters_enabled = false;
+
+#endif
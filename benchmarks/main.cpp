@@ -0,0 +1,66 @@
+/**
+ * Benchmarks of the pathutil library for host builds.
+ *
+ * Usage: pathutil_bench [--quick] [--dir <work_dir>] [--filter <substring>]
+ *
+ * --quick   run each benchmark with reduced number of iterations (smoke test mode)
+ * --dir     directory for temporary files. By default a new directory in the "/tmp" is created
+ * --filter  run only benchmark cases, whose names contain given substring
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "pathutil.h"
+
+static void print_usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [--quick] [--dir <work_dir>] [--filter <substring>]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    bool quick = false;
+    const char *filter = NULL;
+    const char *work_dir = NULL;
+    char tmp_dir[] = "/tmp/pathutil_bench_XXXXXX";
+    bool cleanup_work_dir = false;
+    int ret_code = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        } else if (strcmp(argv[i], "--dir") == 0 && i + 1 < argc) {
+            work_dir = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (work_dir == NULL) {
+        if ((work_dir = mkdtemp(tmp_dir)) == NULL) {
+            perror("Fail to create temporary directory");
+            return 1;
+        }
+        cleanup_work_dir = true;
+    } else if (!pathutil::isdir(work_dir)) {
+        fprintf(stderr, "Directory \"%s\" doesn't exist\n", work_dir);
+        return 1;
+    }
+
+    bench::Context ctx(work_dir, quick);
+    if (bench::run_cases(ctx, filter) == 0) {
+        fprintf(stderr, "No benchmark cases are found\n");
+        ret_code = 1;
+    }
+
+    if (cleanup_work_dir && pathutil::rmtree(work_dir)) {
+        perror("Fail to remove temporary directory");
+        ret_code = 1;
+    }
+    return ret_code;
+}
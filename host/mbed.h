@@ -0,0 +1,134 @@
+#ifndef PATHUTIL_HOST_MBED_H
+#define PATHUTIL_HOST_MBED_H
+
+/**
+ * Minimal replacement of the mbed-os "mbed.h" header for host (Linux/POSIX) builds.
+ *
+ * The pathutil library uses only retargeted POSIX file system functions of the mbed-os
+ * (stat, mkdir, remove, opendir/readdir/closedir, open/read/write/lseek/close),
+ * so on a host system they are mapped directly onto the native POSIX API.
+ * Other used mbed-os functions and classes are implemented below.
+ */
+
+#include <dirent.h>
+#include <pthread.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * Host implementation of the microsecond ticker (see hal/us_ticker_api.h of the mbed-os).
+ *
+ * @return current time in microseconds. Like mbed-os ticker, it wraps around after 2^32 microseconds.
+ */
+static inline uint32_t us_ticker_read(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+typedef uint64_t us_timestamp_t;
+
+/**
+ * Opaque replacement of the mbed-os ticker descriptor (see hal/ticker_api.h).
+ */
+typedef struct ticker_data_s ticker_data_t;
+
+static inline const ticker_data_t *get_us_ticker_data(void)
+{
+    return NULL;
+}
+
+/**
+ * Host implementation of the 64-bit microsecond ticker (see hal/ticker_api.h of the mbed-os).
+ *
+ * @return current time in microseconds. Unlike \c us_ticker_read, it doesn't wrap around.
+ */
+static inline us_timestamp_t ticker_read_us(const ticker_data_t *ticker)
+{
+    struct timespec ts;
+    (void)ticker;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (us_timestamp_t)ts.tv_sec * 1000000u + (us_timestamp_t)ts.tv_nsec / 1000u;
+}
+
+/**
+ * Host implementation of the atomic flag accessors (see platform/mbed_atomic.h of the mbed-os).
+ */
+static inline bool core_util_atomic_load_bool(const volatile bool *valuePtr)
+{
+    return __atomic_load_n(valuePtr, __ATOMIC_SEQ_CST);
+}
+
+static inline void core_util_atomic_store_bool(volatile bool *valuePtr, bool desiredValue)
+{
+    __atomic_store_n(valuePtr, desiredValue, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Host implementation of the mbed-os PlatformMutex (see platform/PlatformMutex.h).
+ */
+class PlatformMutex {
+public:
+    PlatformMutex()
+    {
+        pthread_mutex_init(&_mutex, NULL);
+    }
+
+    ~PlatformMutex()
+    {
+        pthread_mutex_destroy(&_mutex);
+    }
+
+    void lock()
+    {
+        pthread_mutex_lock(&_mutex);
+    }
+
+    void unlock()
+    {
+        pthread_mutex_unlock(&_mutex);
+    }
+
+private:
+    PlatformMutex(const PlatformMutex &);
+    PlatformMutex &operator=(const PlatformMutex &);
+
+    pthread_mutex_t _mutex;
+};
+
+/**
+ * Host implementation of the mbed-os SingletonPtr (see platform/SingletonPtr.h).
+ *
+ * Unlike mbed-os version, it relies on thread-safe initialization of the function static variables,
+ * so all pointers of the same type share one instance.
+ */
+template <typename T>
+struct SingletonPtr {
+    T *get() const
+    {
+        static T instance;
+        return &instance;
+    }
+
+    T *operator->() const
+    {
+        return get();
+    }
+
+    T &operator*() const
+    {
+        return *get();
+    }
+};
+
+#endif // PATHUTIL_HOST_MBED_H
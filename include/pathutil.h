@@ -3,29 +3,672 @@
 
 #include "mbed.h"
 
+/**
+ * Maximal number of simultaneously opened directories by \c rmtree, \c cleartree, \c walk and \c disk_usage functions.
+ */
+#ifndef PATHUTIL_RMTREE_MAX_OPEN_DIRS
+#ifdef MBED_CONF_PATHUTIL_RMTREE_MAX_OPEN_DIRS
+#define PATHUTIL_RMTREE_MAX_OPEN_DIRS MBED_CONF_PATHUTIL_RMTREE_MAX_OPEN_DIRS
+#else
+#define PATHUTIL_RMTREE_MAX_OPEN_DIRS 4
+#endif
+#endif
+
+/**
+ * Use POSIX functions, that work relative to an opened directory (\c openat, \c unlinkat, \c mkdirat, \c fstatat),
+ * for directory tree operations. mbed-os file systems don't have their equivalents, so they are enabled on
+ * host (Linux/POSIX) builds only.
+ */
+#ifndef PATHUTIL_USE_AT_FUNCTIONS
+#if defined(__unix__) || defined(__APPLE__)
+#define PATHUTIL_USE_AT_FUNCTIONS 1
+#else
+#define PATHUTIL_USE_AT_FUNCTIONS 0
+#endif
+#endif
+
+/**
+ * Enable multithreaded functions, that are based on C++11 threads. They are available on host (Linux/POSIX) builds only.
+ */
+#ifndef PATHUTIL_USE_THREADS
+#if defined(__unix__) || defined(__APPLE__)
+#define PATHUTIL_USE_THREADS 1
+#else
+#define PATHUTIL_USE_THREADS 0
+#endif
+#endif
+
+/**
+ * Use \c mmap to map files to memory by \c MappedFile. It's available on host (Linux/POSIX) builds only,
+ * otherwise files are read to a buffer.
+ */
+#ifndef PATHUTIL_USE_MMAP
+#if defined(__unix__) || defined(__APPLE__)
+#define PATHUTIL_USE_MMAP 1
+#else
+#define PATHUTIL_USE_MMAP 0
+#endif
+#endif
+
+/**
+ * Maximal length of the normalized path (including null terminator), that can be stored in the stat cache.
+ * Longer paths bypass the cache.
+ */
+#ifndef PATHUTIL_STAT_CACHE_PATH_MAX
+#ifdef MBED_CONF_PATHUTIL_STAT_CACHE_PATH_MAX
+#define PATHUTIL_STAT_CACHE_PATH_MAX MBED_CONF_PATHUTIL_STAT_CACHE_PATH_MAX
+#else
+#define PATHUTIL_STAT_CACHE_PATH_MAX 64
+#endif
+#endif
+
 namespace pathutil {
 
 /**
  * Remove directory recursively.
  *
+ * The function doesn't use recursion, so its stack usage doesn't depend on the directory depth.
+ * The traversal state is kept in the \p buff and in the fixed set of \p max_open_dirs directory handles.
+ * If the tree is deeper than \p max_open_dirs, the upper directories are closed and reopened later.
+ *
  * @param path directory path
  * @param buff helper buffer to internal operations (it should have size that is enough for longes path in the directory).
  *             If it isn't set, it will be allocated dynamically.
  * @param bull_len length of internal buffer.
+ * @param max_open_dirs maximal number of simultaneously opened directories. If it's 0 or exceeds
+ *                      \c PATHUTIL_RMTREE_MAX_OPEN_DIRS, the \c PATHUTIL_RMTREE_MAX_OPEN_DIRS is used.
  * @return 0, if directory has been deleted successfully, otherwise non-zero value.
  */
-int rmtree(const char *path, char *buff = NULL, size_t buff_len = 0);
+int rmtree(const char *path, char *buff = NULL, size_t buff_len = 0, size_t max_open_dirs = 0);
 
 /**
  * Remove directory content recursively.
  *
+ * It has the same implementation as \c rmtree, but keeps the directory itself.
+ *
  * @param path directory path
  * @param buff helper buffer to internal operations (it should have size that is enough for longes path in the directory).
  *             If it isn't set, it will be allocated dynamically.
  * @param bull_len length of internal buffer.
+ * @param max_open_dirs maximal number of simultaneously opened directories. If it's 0 or exceeds
+ *                      \c PATHUTIL_RMTREE_MAX_OPEN_DIRS, the \c PATHUTIL_RMTREE_MAX_OPEN_DIRS is used.
  * @return 0, if directory content has been deleted successfully, otherwise non-zero value.
  */
-int cleartree(const char *path, char *buff = NULL, size_t buff_len = 0);
+int cleartree(const char *path, char *buff = NULL, size_t buff_len = 0, size_t max_open_dirs = 0);
+
+/**
+ * Event of the directory tree traversal.
+ */
+enum WalkEvent {
+    // directory before its content
+    WALK_PRE_DIR,
+    // directory after its content
+    WALK_POST_DIR,
+    // file, symbolic link or other entry, that isn't directory
+    WALK_FILE
+};
+
+/**
+ * Result of the \c walk callback.
+ */
+enum WalkAction {
+    // continue traversal
+    WALK_CONTINUE = 0,
+    // don't enter directory (it's used with \c WALK_PRE_DIR event)
+    WALK_SKIP = 1,
+    // stop traversal
+    WALK_STOP = 2
+};
+
+/**
+ * Entry of the directory tree traversal.
+ *
+ * Strings are stored in the traversal buffer, so they are valid until the next entry is requested.
+ */
+struct WalkEntry {
+    WalkEvent event;
+    // entry type (DT_DIR, DT_REG, DT_LNK, etc.)
+    unsigned char type;
+    // depth of the entry, that is 0 for the root directory
+    size_t depth;
+    // entry path, that starts with the root directory path
+    const char *path;
+    size_t path_len;
+    // entry name, that is the last component of the path
+    const char *name;
+    // descriptor of the opened parent directory, that can be used with *at functions, or -1 if it isn't available
+    int dir_fd;
+    // result of \c lstat call, if it's done to get unknown entry type, otherwise \c NULL
+    const struct stat *stat;
+};
+
+/**
+ * Iterative traversal of a directory tree.
+ *
+ * The walker doesn't use recursion and dynamic memory, so its stack usage doesn't depend on a tree depth.
+ * The current path is stored in a caller buffer, and only handles of the last \c max_open_dirs levels are
+ * kept opened. If the walker returns to a level, whose handle has been closed, the directory is opened again,
+ * and entries, that have been already read, are skipped. The number of read entries is kept at the end
+ * of the caller buffer (4 bytes per level).
+ *
+ * Entry types are taken from \c dirent::d_type, so the walker calls \c lstat only for entries with
+ * \c DT_UNKNOWN type. Symbolic links aren't followed.
+ *
+ * Example:
+ *
+ * @code
+ * char buff[128];
+ * WalkEntry entry;
+ * TreeWalker walker;
+ * walker.start("/fs/data", buff, sizeof(buff));
+ * while ((ret_code = walker.next(&entry)) > 0) {
+ *     if (entry.event == WALK_PRE_DIR && strcmp(entry.name, "cache") == 0) {
+ *         walker.skip_dir();
+ *     }
+ * }
+ * @endcode
+ */
+class TreeWalker {
+public:
+    /**
+     * Constructor.
+     *
+     * @param max_open_dirs maximal number of simultaneously opened directories. If it's 0 or exceeds
+     *                      \c PATHUTIL_RMTREE_MAX_OPEN_DIRS, the \c PATHUTIL_RMTREE_MAX_OPEN_DIRS is used.
+     */
+    TreeWalker(size_t max_open_dirs = 0);
+    ~TreeWalker();
+
+    /**
+     * Start traversal.
+     *
+     * If previous traversal isn't finished, it's canceled.
+     *
+     * @param path root directory path
+     * @param buff buffer for entry paths. It should be valid until traversal is finished or canceled.
+     * @param buff_len buffer length. It should be enough for the longest path in the tree
+     *                 and 4 bytes per directory level.
+     * @param max_depth maximal depth of the reported entries. Directories of this depth are reported,
+     *                  but their content is skipped. If it's 0, the depth isn't limited.
+     * @param removing flag, that each reported entry is removed by caller (directories on \c WALK_POST_DIR event),
+     *                 so directories are read from the beginning when they are reopened.
+     * @return 0 on success, otherwise -1 and \c errno is set
+     */
+    int start(const char *path, char *buff, size_t buff_len, size_t max_depth = 0, bool removing = false);
+
+    /**
+     * Get next entry.
+     *
+     * Directories are reported twice, with \c WALK_PRE_DIR event before their content and with
+     * \c WALK_POST_DIR after it. Skipped directories and directories of the \c max_depth depth
+     * don't have \c WALK_POST_DIR event. The root directory is reported with depth 0.
+     *
+     * @param entry entry
+     * @return 1 if entry is returned, 0 if traversal is finished, or -1 on error (\c errno is set)
+     */
+    int next(WalkEntry *entry);
+
+    /**
+     * Don't enter the directory, that has been returned with \c WALK_PRE_DIR event by the last \c next call.
+     */
+    void skip_dir();
+
+    /**
+     * Stop traversal and release opened directories.
+     *
+     * @return 0 on success, otherwise non-zero value
+     */
+    int cancel();
+
+    /**
+     * Check if traversal is in progress.
+     */
+    bool is_running() const
+    {
+        return _state == STATE_RUNNING;
+    }
+
+private:
+    // copy isn't allowed
+    TreeWalker(const TreeWalker &);
+    TreeWalker &operator=(const TreeWalker &);
+
+    enum State {
+        STATE_IDLE,
+        STATE_RUNNING,
+        STATE_DONE,
+        STATE_FAILED
+    };
+
+    // action, that should be done before reading of the next entry
+    enum Pending {
+        PENDING_NONE,
+        PENDING_ROOT,
+        PENDING_ENTER,
+        PENDING_POP,
+        PENDING_FINISH
+    };
+
+    DIR *&dir_at(size_t depth)
+    {
+        return _dirs[depth % _max_open_dirs];
+    }
+
+    DIR *current_dir()
+    {
+        return dir_at(_depth);
+    }
+
+    uint32_t *position_at(size_t depth);
+    size_t path_capacity();
+    int current_dir_fd();
+    void fill_entry(WalkEntry *entry, WalkEvent event, unsigned char type, size_t depth, int dir_fd, const struct stat *st);
+    int read_entry(WalkEntry *entry);
+    int push_name(const char *name);
+    DIR *open_child_dir();
+    int enter_dir();
+    int leave_dir(WalkEntry *entry);
+    int close_all();
+
+    State _state;
+    Pending _pending;
+
+    char *_path;
+    // length of the current directory path
+    size_t _path_len;
+    // length of the last reported entry path
+    size_t _entry_len;
+    size_t _root_len;
+    size_t _buff_len;
+    size_t _max_depth;
+    bool _removing;
+
+    // depth of the current directory relative to the root one
+    size_t _depth;
+    // depth of the most top opened directory
+    size_t _open_depth;
+    // flag that directories [_open_depth, _depth] are opened
+    bool _opened;
+
+    size_t _max_open_dirs;
+    DIR *_dirs[PATHUTIL_RMTREE_MAX_OPEN_DIRS];
+    struct stat _stat;
+};
+
+/**
+ * Callback of the directory tree traversal.
+ *
+ * @param entry entry
+ * @param context user data
+ * @return \c WalkAction value, or -1 to stop traversal with error
+ */
+typedef int (*WalkCallback)(const WalkEntry &entry, void *context);
+
+/**
+ * Traverse directory tree.
+ *
+ * It's a callback version of the \c TreeWalker, so it doesn't use recursion and dynamic memory.
+ *
+ * Example:
+ *
+ * @code
+ * static int count_files(const WalkEntry &entry, void *context)
+ * {
+ *     if (entry.event == WALK_FILE) {
+ *         (*(size_t *)context)++;
+ *     }
+ *     return WALK_CONTINUE;
+ * }
+ *
+ * size_t files = 0;
+ * char buff[128];
+ * walk("/fs/data", count_files, &files, buff, sizeof(buff));
+ * @endcode
+ *
+ * @param path root directory path
+ * @param callback callback, that is called for each entry
+ * @param context user data of the callback
+ * @param buff buffer for entry paths (see \c TreeWalker::start)
+ * @param buff_len buffer length
+ * @param max_depth maximal depth of the reported entries. If it's 0, the depth isn't limited.
+ * @param max_open_dirs maximal number of simultaneously opened directories (see \c TreeWalker::TreeWalker)
+ * @return 0 on success, \c WALK_STOP if traversal is stopped by callback, or -1 on error (\c errno is set)
+ */
+int walk(const char *path, WalkCallback callback, void *context, char *buff, size_t buff_len, size_t max_depth = 0,
+         size_t max_open_dirs = 0);
+
+/**
+ * Incremental remover of a directory tree.
+ *
+ * It removes a tree by small portions, so a removal of a large tree doesn't block the calling thread
+ * for a long time. Each \c step call removes entries until the time or entries budget is exhausted,
+ * and keeps the traversal state (opened directories and current path) till the next call.
+ *
+ * It's the same engine as \c rmtree and \c cleartree functions use. Entries are enumerated by \c TreeWalker,
+ * so the remover doesn't use recursion and keeps only \c max_open_dirs directories opened.
+ *
+ * Example:
+ *
+ * @code
+ * TreeRemover remover;
+ * if (remover.start("/fs/logs")) {
+ *     // process error
+ * }
+ * while ((ret_code = remover.step(32, 5000)) > 0) {
+ *     // do other work
+ * }
+ * @endcode
+ */
+class TreeRemover {
+public:
+    /**
+     * Constructor.
+     *
+     * @param max_open_dirs maximal number of simultaneously opened directories. If it's 0 or exceeds
+     *                      \c PATHUTIL_RMTREE_MAX_OPEN_DIRS, the \c PATHUTIL_RMTREE_MAX_OPEN_DIRS is used.
+     */
+    TreeRemover(size_t max_open_dirs = 0);
+    ~TreeRemover();
+
+    /**
+     * Start tree removal.
+     *
+     * If previous removal isn't finished, it's canceled.
+     *
+     * @param path directory path
+     * @param remove_root if it's \c true the directory itself is removed (\c rmtree), otherwise only its content (\c cleartree)
+     * @param count_bytes count sizes of the removed files. It requires additional \c stat call for each file.
+     * @param buff helper buffer to internal operations (it should have size that is enough for longes path in the directory).
+     *             If it isn't set, it will be allocated dynamically. It should be valid until removal is finished or canceled.
+     * @param buff_len length of internal buffer.
+     * @return 0 on success, otherwise non-zero value
+     */
+    int start(const char *path, bool remove_root = true, bool count_bytes = false, char *buff = NULL, size_t buff_len = 0);
+
+    /**
+     * Remove next portion of the tree.
+     *
+     * @param max_entries maximal number of entries to remove. If it's 0, the number isn't limited.
+     * @param max_time_us time budget in microseconds. If it's 0, the time isn't limited.
+     *                    The budget is checked after each entry, so the step can exceed it by one file system operation.
+     * @return 1 if removal isn't finished, 0 if tree has been removed, or negative value on error
+     */
+    int step(size_t max_entries = 0, uint32_t max_time_us = 0);
+
+    /**
+     * Stop removal and release opened directories.
+     *
+     * The already removed entries aren't restored.
+     *
+     * @return 0 on success, otherwise non-zero value
+     */
+    int cancel();
+
+    /**
+     * Check if removal is in progress.
+     */
+    bool is_running() const
+    {
+        return _state == STATE_RUNNING;
+    }
+
+    /**
+     * Check if tree has been removed successfully.
+     */
+    bool is_done() const
+    {
+        return _state == STATE_DONE;
+    }
+
+    /**
+     * Get number of removed entries (files and directories).
+     */
+    size_t entries_removed() const
+    {
+        return _entries_removed;
+    }
+
+    /**
+     * Get total size of the removed files. It's counted only if \c count_bytes flag is set.
+     */
+    uint64_t bytes_freed() const
+    {
+        return _bytes_freed;
+    }
+
+private:
+    // copy isn't allowed
+    TreeRemover(const TreeRemover &);
+    TreeRemover &operator=(const TreeRemover &);
+
+    enum State {
+        STATE_IDLE,
+        STATE_RUNNING,
+        STATE_DONE,
+        STATE_FAILED
+    };
+
+    int next();
+    void release_buff();
+
+    State _state;
+    TreeWalker _walker;
+
+    char *_path;
+    size_t _root_len;
+    bool _cleanup_buff;
+    bool _remove_root;
+    bool _count_bytes;
+
+    size_t _entries_removed;
+    uint64_t _bytes_freed;
+};
+
+#if PATHUTIL_USE_THREADS
+/**
+ * Remove directory recursively using several threads.
+ *
+ * Subdirectories are distributed between threads of a work-stealing pool. Each directory is removed
+ * after all its subdirectories have been removed. The function has the same error contract as \c rmtree:
+ * on error \c errno is set to the first error, that has been detected by any thread.
+ *
+ * @param path directory path
+ * @param nthreads number of threads including the calling one. If it's 0, the number of hardware threads is used.
+ * @return 0, if directory has been deleted successfully, otherwise non-zero value.
+ */
+int rmtree_parallel(const char *path, size_t nthreads = 0);
+#endif
+
+/**
+ * Incremental calculator of a directory tree disk usage.
+ *
+ * It's a \c TreeRemover counterpart, that counts entries instead of their removal, so a large tree
+ * can be scanned by small portions without blocking the calling thread for a long time.
+ * Each \c step call processes entries until the time or entries budget is exhausted.
+ *
+ * File sizes are got by \c lstat relative to the opened directory (\c fstatat) on host builds,
+ * and by \c stat of the full path on mbed-os. Directories don't require \c stat calls.
+ *
+ * Example:
+ *
+ * @code
+ * DiskUsageScanner scanner;
+ * scanner.start("/fs/logs");
+ * while ((ret_code = scanner.step(32, 5000)) > 0) {
+ *     // do other work
+ * }
+ * if (ret_code == 0) {
+ *     printf("%llu bytes\n", (unsigned long long)scanner.bytes());
+ * }
+ * @endcode
+ */
+class DiskUsageScanner {
+public:
+    /**
+     * Constructor.
+     *
+     * @param max_open_dirs maximal number of simultaneously opened directories. If it's 0 or exceeds
+     *                      \c PATHUTIL_RMTREE_MAX_OPEN_DIRS, the \c PATHUTIL_RMTREE_MAX_OPEN_DIRS is used.
+     */
+    DiskUsageScanner(size_t max_open_dirs = 0);
+    ~DiskUsageScanner();
+
+    /**
+     * Start tree scanning.
+     *
+     * If previous scanning isn't finished, it's canceled. Counters are reset.
+     *
+     * @param path directory path
+     * @param buff buffer for entry paths (see \c TreeWalker::start). If it isn't set, it will be allocated dynamically.
+     *             It should be valid until scanning is finished or canceled.
+     * @param buff_len buffer length
+     * @return 0 on success, otherwise non-zero value
+     */
+    int start(const char *path, char *buff = NULL, size_t buff_len = 0);
+
+    /**
+     * Scan next portion of the tree.
+     *
+     * @param max_entries maximal number of entries to process. If it's 0, the number isn't limited.
+     * @param max_time_us time budget in microseconds. If it's 0, the time isn't limited.
+     *                    The budget is checked after each entry, so the step can exceed it by one file system operation.
+     * @return 1 if scanning isn't finished, 0 if tree has been scanned, or negative value on error
+     */
+    int step(size_t max_entries = 0, uint32_t max_time_us = 0);
+
+    /**
+     * Stop scanning and release opened directories.
+     *
+     * Counters keep values of the processed entries.
+     *
+     * @return 0 on success, otherwise non-zero value
+     */
+    int cancel();
+
+    /**
+     * Check if scanning is in progress.
+     */
+    bool is_running() const
+    {
+        return _state == STATE_RUNNING;
+    }
+
+    /**
+     * Check if tree has been scanned successfully.
+     */
+    bool is_done() const
+    {
+        return _state == STATE_DONE;
+    }
+
+    /**
+     * Get total size of the files (including symbolic links, that aren't followed).
+     */
+    uint64_t bytes() const
+    {
+        return _bytes;
+    }
+
+    /**
+     * Get number of files (all entries except directories).
+     */
+    size_t files() const
+    {
+        return _files;
+    }
+
+    /**
+     * Get number of subdirectories. The root directory isn't counted.
+     */
+    size_t dirs() const
+    {
+        return _dirs;
+    }
+
+private:
+    // copy isn't allowed
+    DiskUsageScanner(const DiskUsageScanner &);
+    DiskUsageScanner &operator=(const DiskUsageScanner &);
+
+    enum State {
+        STATE_IDLE,
+        STATE_RUNNING,
+        STATE_DONE,
+        STATE_FAILED
+    };
+
+    int next();
+    void release_buff();
+
+    State _state;
+    TreeWalker _walker;
+
+    char *_buff;
+    bool _cleanup_buff;
+
+    uint64_t _bytes;
+    size_t _files;
+    size_t _dirs;
+};
+
+/**
+ * Calculate disk usage of a directory tree.
+ *
+ * It's the same engine as \c DiskUsageScanner uses, so the function doesn't use recursion and
+ * issues \c stat calls only for files.
+ *
+ * @param path directory path
+ * @param bytes total size of the files. It can be \c NULL.
+ * @param files number of files (all entries except directories). It can be \c NULL.
+ * @param dirs number of subdirectories without the root one. It can be \c NULL.
+ * @param buff buffer for entry paths (see \c TreeWalker::start). If it isn't set, it will be allocated dynamically.
+ * @param buff_len buffer length
+ * @param max_open_dirs maximal number of simultaneously opened directories. If it's 0 or exceeds
+ *                      \c PATHUTIL_RMTREE_MAX_OPEN_DIRS, the \c PATHUTIL_RMTREE_MAX_OPEN_DIRS is used.
+ * @return 0 on success, otherwise -1 and \c errno is set
+ */
+int disk_usage(const char *path, uint64_t *bytes, size_t *files = NULL, size_t *dirs = NULL, char *buff = NULL,
+               size_t buff_len = 0, size_t max_open_dirs = 0);
+
+#if PATHUTIL_USE_THREADS
+/**
+ * Calculate disk usage of a directory tree using several threads.
+ *
+ * Subdirectories are distributed between threads of the same work-stealing pool, that \c rmtree_parallel uses.
+ * Results are the same as \c disk_usage ones.
+ *
+ * @param path directory path
+ * @param bytes total size of the files. It can be \c NULL.
+ * @param files number of files (all entries except directories). It can be \c NULL.
+ * @param dirs number of subdirectories without the root one. It can be \c NULL.
+ * @param nthreads number of threads including the calling one. If it's 0, the number of hardware threads is used.
+ * @return 0 on success, otherwise -1 and \c errno is set to the first error, that has been detected by any thread
+ */
+int disk_usage_parallel(const char *path, uint64_t *bytes, size_t *files = NULL, size_t *dirs = NULL, size_t nthreads = 0);
+#endif
+
+/**
+ * Strategy of the \c makedirs function to find existing part of the path.
+ */
+enum MakedirsStrategy {
+    /**
+     * Check path prefixes with \c stat from the leaf to the root, then create missing directories.
+     */
+    MAKEDIRS_STAT_FIRST = 0,
+    /**
+     * Try to create the leaf directory at first and check parent directories only if it fails with \c ENOENT.
+     * It needs single \c mkdir call, if only leaf directory is missing.
+     */
+    MAKEDIRS_MKDIR_FIRST
+};
+
+/**
+ * Number of file system calls of the \c makedirs function.
+ */
+struct MakedirsStats {
+    size_t stat_calls;
+    size_t mkdir_calls;
+};
 
 /**
  * Create directory and parent one, if they are missed.
@@ -34,9 +677,118 @@ int cleartree(const char *path, char *buff = NULL, size_t buff_len = 0);
  * @param exists_ok
  * @param buff - buffer for internal operations. It should have size same as path. If it isn't set, it will be allocated dynamically.
  * @param buff_len - length of internal buffer.
+ * @param strategy - strategy to find existing part of the path.
+ * @param stats - optional counters of \c stat and \c mkdir calls of this invocation.
  * @return 0 on success, otherwise non-zero value
  */
-int makedirs(const char *path, mode_t mode = 0777, bool exists_ok = false, char *buff = NULL, size_t buff_len = 0);
+int makedirs(const char *path, mode_t mode = 0777, bool exists_ok = false, char *buff = NULL, size_t buff_len = 0,
+             MakedirsStrategy strategy = MAKEDIRS_STAT_FIRST, MakedirsStats *stats = NULL);
+
+/**
+ * Get size of the buffer, that is needed by \c makedirs_batch for internal operations.
+ *
+ * @param paths
+ * @param n - number of paths
+ * @return buffer size
+ */
+size_t makedirs_batch_buff_size(const char *const *paths, size_t n);
+
+/**
+ * Create several directories and their parents, if they are missed.
+ *
+ * Paths are normalized and sorted, so each distinct parent directory is checked or created only once.
+ * Existing directories aren't considered as error. Like \c makedirs, top level directories (mount points)
+ * aren't created.
+ *
+ * @param paths - absolute directory paths
+ * @param n - number of paths
+ * @param mode
+ * @param errors - optional array of \p n items. It's filled with 0 for created/existing directories
+ *                 and \c errno value for failed ones.
+ * @param buff - buffer for internal operations. It should have at least \c makedirs_batch_buff_size bytes.
+ *               If it isn't set, it will be allocated dynamically.
+ * @param buff_len - length of internal buffer.
+ * @param stats - optional counters of \c stat and \c mkdir calls.
+ * @return 0 if all directories have been created, otherwise non-zero value. In case of error \c errno
+ *         is set to error of the first failed path.
+ */
+int makedirs_batch(const char *const *paths, size_t n, mode_t mode = 0777, int *errors = NULL,
+                   char *buff = NULL, size_t buff_len = 0, MakedirsStats *stats = NULL);
+
+/**
+ * Type of the file system entry.
+ */
+enum PathType {
+    PATH_TYPE_NONE = 0,
+    PATH_TYPE_FILE,
+    PATH_TYPE_DIR,
+    PATH_TYPE_OTHER
+};
+
+/**
+ * File system entry information, that is got by single \c stat call.
+ */
+struct PathInfo {
+    PathType type;
+    off_t size;
+    time_t mtime;
+    // errno of the failed stat call or 0
+    int error;
+};
+
+/**
+ * Get type, size and modification time of the path.
+ *
+ * Unlike other functions, it doesn't modify \c errno. Error code is stored in the \c PathInfo::error field.
+ * The function uses stat cache, if it's enabled.
+ *
+ * @param path
+ * @param info
+ * @return 0, if path exists, otherwise -1
+ */
+int path_info(const char *path, PathInfo *info);
+
+/**
+ * Get information of several paths.
+ *
+ * @param paths
+ * @param n - number of paths
+ * @param infos - array of \p n items
+ * @return number of existing paths
+ */
+size_t path_info_batch(const char *const *paths, size_t n, PathInfo *infos);
+
+/**
+ * Get information of several paths, grouping them by parent directory.
+ *
+ * Each parent directory is resolved only once. On host builds the paths are checked relative to the opened
+ * parent directory (\c fstatat). On mbed-os, if only types are requested, each directory with several
+ * requested entries is read once instead of separate \c stat calls. Unlike \c path_info_batch,
+ * it doesn't use stat cache. \c errno is modified only in case of buffer errors.
+ *
+ * @param paths
+ * @param n - number of paths
+ * @param results - array of \p n items
+ * @param type_only - only \c PathInfo::type and \c PathInfo::error fields are required
+ * @param buff - buffer for internal operations. It should have at least \c stat_batch_buff_size bytes.
+ *               If it isn't set, it will be allocated dynamically.
+ * @param buff_len - length of internal buffer.
+ * @return number of existing paths, or -1 on error
+ */
+ssize_t stat_batch(const char *const *paths, size_t n, PathInfo *results, bool type_only = false,
+                   char *buff = NULL, size_t buff_len = 0);
+
+/**
+ * Get size of the buffer, that is needed by \c stat_batch for internal operations.
+ *
+ * @param paths
+ * @param n - number of paths
+ * @return buffer size
+ */
+inline size_t stat_batch_buff_size(const char *const *paths, size_t n)
+{
+    return makedirs_batch_buff_size(paths, n);
+}
 
 /**
  * Check if given path is directory.
@@ -44,7 +796,11 @@ int makedirs(const char *path, mode_t mode = 0777, bool exists_ok = false, char
  * @param path
  * @return
  */
-bool isdir(const char *path);
+inline bool isdir(const char *path)
+{
+    PathInfo info;
+    return path_info(path, &info) == 0 && info.type == PATH_TYPE_DIR;
+}
 
 /**
  * Check if give file is regular file.
@@ -52,7 +808,11 @@ bool isdir(const char *path);
  * @param path
  * @return
  */
-bool isfile(const char *path);
+inline bool isfile(const char *path)
+{
+    PathInfo info;
+    return path_info(path, &info) == 0 && info.type == PATH_TYPE_FILE;
+}
 
 /**
  * Check if given path exists.
@@ -60,7 +820,11 @@ bool isfile(const char *path);
  * @param path
  * @return
  */
-bool exists(const char *path);
+inline bool exists(const char *path)
+{
+    PathInfo info;
+    return path_info(path, &info) == 0;
+}
 
 /**
  * Get file size.
@@ -68,7 +832,69 @@ bool exists(const char *path);
  * @param path
  * @return file size on success, otherwise negative value
  */
-ssize_t getsize(const char *path);
+inline ssize_t getsize(const char *path)
+{
+    PathInfo info;
+    if (path_info(path, &info)) {
+        errno = info.error;
+        return -1;
+    }
+    return info.size;
+}
+
+/**
+ * Counters of the stat cache.
+ */
+struct StatCacheStats {
+    uint32_t hits;
+    uint32_t misses;
+};
+
+/**
+ * Enable cache of the \c stat results, that is used by \c isdir, \c isfile, \c exists, \c getsize
+ * and \c stat_cached functions.
+ *
+ * The cache is a fixed-size hash table, so memory is allocated only by this function. If the cache is full,
+ * the oldest entry of the hash bucket is replaced. Functions of the library, that modify file system
+ * (\c write_data, \c makedirs, \c rmtree, etc.), invalidate the affected entries automatically, but other changes
+ * should be reported with \c stat_cache_invalidate.
+ *
+ * @param capacity - number of cache entries. It's rounded up to power of two.
+ * @param ttl_ms - lifetime of the entries in milliseconds. If it's 0, entries don't expire. Any value up to
+ *                 \c UINT32_MAX (about 49 days) is exact, as entry age is measured by the 64-bit microsecond ticker.
+ * @return 0 on success, otherwise non-zero value
+ */
+int stat_cache_enable(size_t capacity, uint32_t ttl_ms = 0);
+
+/**
+ * Disable stat cache and release its memory.
+ */
+void stat_cache_disable();
+
+/**
+ * Invalidate cached entries of the path, its parent directories and its content.
+ *
+ * @param path - path to invalidate. If it's \c NULL, all entries are invalidated.
+ */
+void stat_cache_invalidate(const char *path = NULL);
+
+/**
+ * Get counters of the stat cache.
+ *
+ * @param stats
+ * @param reset - reset counters after reading
+ */
+void stat_cache_get_stats(StatCacheStats *stats, bool reset = false);
+
+/**
+ * Get file status using stat cache, if it's enabled. Only \c st_mode, \c st_size and \c st_mtime fields
+ * are filled for cached results.
+ *
+ * @param path
+ * @param buf
+ * @return 0 on success, otherwise -1 and \c errno is set
+ */
+int stat_cached(const char *path, struct stat *buf);
 
 /**
  * Check if given path is absolute.
@@ -78,6 +904,445 @@ ssize_t getsize(const char *path);
  */
 bool isabs(const char *path);
 
+/**
+ * Non-owning view of a path (pointer and length).
+ *
+ * The view doesn't copy the path and doesn't require null terminator, so the methods return sub-views
+ * of the same string. The referenced string should outlive the view.
+ *
+ * The path components (non-empty parts between separators) can be iterated in forward and reverse order:
+ *
+ * @code
+ * for (PathView part : PathView("/test_bd//config/settings.txt")) {
+ *     // "test_bd", "config", "settings.txt"
+ * }
+ * for (PathView part : PathView("/test_bd//config/settings.txt").reversed()) {
+ *     // "settings.txt", "config", "test_bd"
+ * }
+ * @endcode
+ */
+class PathView {
+public:
+    /**
+     * Iterator of the path components.
+     */
+    class Iterator {
+    public:
+        Iterator(const char *path, size_t len, size_t pos)
+            : _path(path)
+            , _len(len)
+            , _start(pos)
+            , _end(pos)
+        {
+            if (pos < len) {
+                // move to the first component
+                ++(*this);
+            }
+        }
+
+        PathView operator*() const
+        {
+            return PathView(_path + _start, _end - _start);
+        }
+
+        Iterator &operator++()
+        {
+            _start = _end;
+            while (_start < _len && _path[_start] == '/') {
+                _start++;
+            }
+            _end = _start;
+            while (_end < _len && _path[_end] != '/') {
+                _end++;
+            }
+            return *this;
+        }
+
+        bool operator==(const Iterator &other) const
+        {
+            return _start == other._start;
+        }
+
+        bool operator!=(const Iterator &other) const
+        {
+            return _start != other._start;
+        }
+
+    private:
+        const char *_path;
+        size_t _len;
+        size_t _start;
+        size_t _end;
+    };
+
+    /**
+     * Iterator of the path components in reverse order.
+     */
+    class ReverseIterator {
+    public:
+        ReverseIterator(const char *path, size_t pos)
+            : _path(path)
+            , _start(pos)
+            , _end(pos)
+        {
+            if (pos > 0) {
+                // move to the last component
+                ++(*this);
+            }
+        }
+
+        PathView operator*() const
+        {
+            return PathView(_path + _start, _end - _start);
+        }
+
+        ReverseIterator &operator++()
+        {
+            _end = _start;
+            while (_end > 0 && _path[_end - 1] == '/') {
+                _end--;
+            }
+            _start = _end;
+            while (_start > 0 && _path[_start - 1] != '/') {
+                _start--;
+            }
+            return *this;
+        }
+
+        bool operator==(const ReverseIterator &other) const
+        {
+            return _end == other._end;
+        }
+
+        bool operator!=(const ReverseIterator &other) const
+        {
+            return _end != other._end;
+        }
+
+    private:
+        const char *_path;
+        size_t _start;
+        size_t _end;
+    };
+
+    /**
+     * Range of the path components in reverse order.
+     */
+    class ReverseRange {
+    public:
+        ReverseRange(const char *path, size_t len)
+            : _path(path)
+            , _len(len)
+        {
+        }
+
+        ReverseIterator begin() const
+        {
+            return ReverseIterator(_path, _len);
+        }
+
+        ReverseIterator end() const
+        {
+            return ReverseIterator(_path, 0);
+        }
+
+    private:
+        const char *_path;
+        size_t _len;
+    };
+
+    PathView()
+        : _data("")
+        , _len(0)
+    {
+    }
+
+    explicit PathView(const char *path)
+        : _data(path)
+        , _len(strlen(path))
+    {
+    }
+
+    PathView(const char *path, size_t len)
+        : _data(path)
+        , _len(len)
+    {
+    }
+
+    const char *data() const
+    {
+        return _data;
+    }
+
+    size_t size() const
+    {
+        return _len;
+    }
+
+    bool empty() const
+    {
+        return _len == 0;
+    }
+
+    bool is_absolute() const
+    {
+        return _len > 0 && _data[0] == '/';
+    }
+
+    /**
+     * Compare view with a string.
+     *
+     * @param path
+     * @return true if strings are equal
+     */
+    bool equals(const char *path) const
+    {
+        return strncmp(_data, path, _len) == 0 && path[_len] == '\0';
+    }
+
+    /**
+     * Copy view to a buffer and add null terminator.
+     *
+     * The buffer may overlap with the view.
+     *
+     * @param buff output buffer
+     * @param n size of the \p buff
+     * @return 0 on success, otherwise -1 and \c errno is set to \c ENOBUFS
+     */
+    int copy(char *buff, size_t n) const;
+
+    /**
+     * Get parent directory (the same result as \c dirname gives).
+     *
+     * @return parent directory or empty view, if path has no separators
+     */
+    PathView parent() const;
+
+    /**
+     * Get last path part after the separator (the same result as \c basename gives).
+     *
+     * @return file name. It's empty if path ends with separator.
+     */
+    PathView filename() const;
+
+    /**
+     * Get file name without extension.
+     *
+     * @return file name stem
+     */
+    PathView stem() const;
+
+    /**
+     * Get file name extension including leading dot, e.g. ".txt". Leading dots of the file name aren't
+     * treated as extension separators, so ".config" and ".." have no extension.
+     *
+     * @return file name extension or empty view
+     */
+    PathView extension() const;
+
+    Iterator begin() const
+    {
+        return Iterator(_data, _len, 0);
+    }
+
+    Iterator end() const
+    {
+        return Iterator(_data, _len, _len);
+    }
+
+    ReverseIterator rbegin() const
+    {
+        return ReverseIterator(_data, _len);
+    }
+
+    ReverseIterator rend() const
+    {
+        return ReverseIterator(_data, 0);
+    }
+
+    ReverseRange reversed() const
+    {
+        return ReverseRange(_data, _len);
+    }
+
+private:
+    const char *_data;
+    size_t _len;
+};
+
+/**
+ * Path stored in a fixed-size buffer with known length.
+ *
+ * It's base class of the \c PathBuffer template, that doesn't depend on the buffer capacity, so it can be
+ * used to pass path buffers of any size or to wrap external buffer. All modifications check the buffer
+ * bounds. If the path doesn't fit the buffer, a method returns -1, sets \c errno to \c ENOBUFS
+ * and keeps the buffer unchanged.
+ */
+class PathBufferBase {
+public:
+    /**
+     * Constructor.
+     *
+     * @param buff buffer, that contains path of the \p len length (it isn't checked)
+     * @param capacity buffer size including null terminator
+     * @param len length of the path in the buffer
+     */
+    PathBufferBase(char *buff, size_t capacity, size_t len = 0)
+        : _buff(buff)
+        , _capacity(capacity)
+        , _len(len)
+    {
+    }
+
+    const char *c_str() const
+    {
+        return _buff;
+    }
+
+    size_t size() const
+    {
+        return _len;
+    }
+
+    size_t capacity() const
+    {
+        return _capacity;
+    }
+
+    bool empty() const
+    {
+        return _len == 0;
+    }
+
+    void clear()
+    {
+        truncate(0);
+    }
+
+    /**
+     * Restore path length, that has been got with \c size method before appending.
+     *
+     * @param len new path length. It should be less than or equal to current one.
+     */
+    void truncate(size_t len)
+    {
+        _len = len;
+        _buff[len] = '\0';
+    }
+
+    /**
+     * Replace path.
+     *
+     * @param path
+     * @return 0 on success, otherwise non-zero value
+     */
+    int assign(const char *path);
+
+    /**
+     * Append path like \c append_path function does. If \p path_r is absolute, it replaces current path.
+     *
+     * @param path_r
+     * @return 0 on success, otherwise non-zero value
+     */
+    int append(const char *path_r);
+
+    /**
+     * Normalize path in place (see \c normpath).
+     *
+     * @return 0
+     */
+    int normalize();
+
+    /**
+     * Replace path by its parent directory in place (see \c dirname).
+     *
+     * @return 0
+     */
+    int dirname();
+
+    /**
+     * Get base name of the path (see \c basename).
+     *
+     * @return pointer to the base name inside the buffer
+     */
+    const char *basename() const;
+
+    /**
+     * Helper, that appends path part during its lifetime. It's designed for directory traversal.
+     */
+    class ScopedPush {
+    public:
+        ScopedPush(PathBufferBase &path, const char *name)
+            : _path(path)
+            , _len(path.size())
+            , _ret_code(path.append(name))
+        {
+        }
+
+        ~ScopedPush()
+        {
+            _path.truncate(_len);
+        }
+
+        /**
+         * Get result of the path appending.
+         *
+         * @return 0 on success, otherwise non-zero value
+         */
+        int error() const
+        {
+            return _ret_code;
+        }
+
+    private:
+        ScopedPush(const ScopedPush &);
+        ScopedPush &operator=(const ScopedPush &);
+
+        PathBufferBase &_path;
+        size_t _len;
+        int _ret_code;
+    };
+
+protected:
+    PathBufferBase(const PathBufferBase &);
+    PathBufferBase &operator=(const PathBufferBase &);
+
+    char *_buff;
+    size_t _capacity;
+    size_t _len;
+};
+
+/**
+ * Path buffer of the fixed capacity.
+ *
+ * @tparam N buffer size including null terminator
+ */
+template <size_t N>
+class PathBuffer : public PathBufferBase {
+public:
+    PathBuffer()
+        : PathBufferBase(_data, N)
+    {
+        _data[0] = '\0';
+    }
+
+    PathBuffer(const PathBuffer &other)
+        : PathBufferBase(_data, N, other._len)
+    {
+        memcpy(_data, other._data, other._len + 1);
+    }
+
+    PathBuffer &operator=(const PathBuffer &other)
+    {
+        memcpy(_data, other._data, other._len + 1);
+        _len = other._len;
+        return *this;
+    }
+
+private:
+    char _data[N];
+};
+
 /**
  * Join paths.
  *
@@ -85,19 +1350,80 @@ bool isabs(const char *path);
  * @param n length of output_path buffer
  * @param path_l left part of path
  * @param path_r right path of path
- * @return  0 on success, otherwise non-zero value (the output buffer is too small)
+ * @return  0 on success, otherwise non-zero value (the output buffer is too small). On failure
+ *          \c errno is set to \c ENOBUFS and the output buffer is kept unchanged.
+ */
+int join_paths(char *output_path, size_t n, const char *path_l, const char *path_r);
+
+/**
+ * Join paths.
+ *
+ * @param output_path output path string. It should be large enough for result.
+ * @param path_l left part of path
+ * @param path_r right path of path
+ * @return 0
+ */
+int join_paths(char *output_path, const char *path_l, const char *path_r);
+
+/**
+ * Join several paths.
+ *
+ * Parts are joined from left to right like \c join_paths does with two paths, so an absolute part replaces
+ * the preceding ones. Joining starts from the last absolute part, so the preceding ones aren't copied and
+ * don't have to fit the buffer. Each part is scanned only once.
+ *
+ * @param output_path output path buffer
+ * @param n length of output_path buffer
+ * @param parts path parts
+ * @param parts_num number of parts
+ * @return 0 on success, otherwise non-zero value (the output buffer is too small)
  */
-int join_paths(char *output_path, size_t n, const char *path_l, const char *path_r);
+inline int join_paths(char *output_path, size_t n, const char *const *parts, size_t parts_num)
+{
+    PathBufferBase path(output_path, n);
+    if (n == 0) {
+        errno = ENOBUFS;
+        return -1;
+    }
+    if (parts_num == 0) {
+        output_path[0] = '\0';
+        return 0;
+    }
+    // parts before the last absolute one don't affect the result, so they aren't copied
+    size_t first = parts_num - 1;
+    while (first > 0 && !isabs(parts[first])) {
+        first--;
+    }
+    if (path.assign(parts[first])) {
+        return -1;
+    }
+    for (size_t i = first + 1; i < parts_num; i++) {
+        if (path.append(parts[i])) {
+            return -1;
+        }
+    }
+    return 0;
+}
 
 /**
- * Join paths.
+ * Join three or more paths.
  *
- * @param output_path output path string. It should be large enough for result.
- * @param path_l left part of path
- * @param path_r right path of path
- * @return 0
+ * Example: \c join_paths(buf, sizeof(buf), BASE_DIR, "dev", dev_id, "cfg", name)
+ *
+ * @param output_path output path buffer
+ * @param n length of output_path buffer
+ * @param path_a first part of path
+ * @param path_b second part of path
+ * @param path_c third part of path
+ * @param paths other parts of path
+ * @return 0 on success, otherwise non-zero value (the output buffer is too small)
  */
-int join_paths(char *output_path, const char *path_l, const char *path_r);
+template <typename... Paths>
+inline int join_paths(char *output_path, size_t n, const char *path_a, const char *path_b, const char *path_c, Paths... paths)
+{
+    const char *parts[] = {path_a, path_b, path_c, paths...};
+    return join_paths(output_path, n, parts, sizeof(parts) / sizeof(parts[0]));
+}
 
 /**
  * Append part to current path.
@@ -126,6 +1452,47 @@ int append_path(char *path, const char *path_r);
  */
 int normpath(char *path);
 
+/**
+ * Check if path is normalized, so \c normpath doesn't change it.
+ *
+ * The path is scanned for separator sequences with SIMD instructions (SSE2/AVX2/NEON) on host builds
+ * or word-at-a-time on microcontrollers.
+ *
+ * @param path
+ * @return true if path is normalized
+ */
+bool is_normalized(const char *path);
+
+/**
+ * Normalize several paths, that are stored in one buffer.
+ *
+ * Each path is normalized in place like \c normpath does. Lengths of the results are saved to a separate
+ * array, so they can be used without \c strlen calls.
+ *
+ * @param buff buffer with null terminated paths
+ * @param offsets offsets of the paths in the \p buff
+ * @param count number of paths
+ * @param lengths optional array to save lengths of the normalized paths
+ * @return 0
+ */
+int normpath_batch(char *buff, const size_t *offsets, size_t count, size_t *lengths = NULL);
+
+#if PATHUTIL_USE_THREADS
+/**
+ * Normalize several paths, that are stored in one buffer, using several threads.
+ *
+ * Paths are split into chunks, that are taken by threads dynamically. Results are the same as \c normpath_batch gives.
+ *
+ * @param buff buffer with null terminated paths
+ * @param offsets offsets of the paths in the \p buff
+ * @param count number of paths
+ * @param lengths optional array to save lengths of the normalized paths
+ * @param nthreads number of threads including the calling one. If it's 0, the number of hardware threads is used.
+ * @return 0
+ */
+int normpath_batch_parallel(char *buff, const size_t *offsets, size_t count, size_t *lengths = NULL, size_t nthreads = 0);
+#endif
+
 /**
  * Get base name of the path.
  *
@@ -172,6 +1539,585 @@ int dirname(char *dirpath, size_t n, const char *path);
  */
 int dirname(char *dirpath, const char *path);
 
+/**
+ * Get relative path from the \p start directory to the \p path.
+ *
+ * Both paths are normalized like \c normpath does, but without copying, so \c "/a/./b/../c" and \c "/a/c"
+ * give the same result. The output buffer shouldn't overlap with input paths.
+ *
+ * Example: \c relpath(buf, sizeof(buf), "/test_bd/data/log.txt", "/test_bd/config") gives \c "../data/log.txt"
+ *
+ * @param output_path output path buffer
+ * @param n length of output_path buffer
+ * @param path target path
+ * @param start start directory
+ * @return 0 on success, otherwise -1 and \c errno is set. \c EINVAL is set if paths are empty, one of them is
+ *         absolute and another isn't, or relative \p start goes above the common prefix (e.g. "../x").
+ *         \c ENOBUFS is set if the output buffer is too small.
+ */
+int relpath(char *output_path, size_t n, const char *path, const char *start);
+
+/**
+ * Get the longest common sub-path of the paths.
+ *
+ * Paths are compared by components after normalization (see \c relpath), so the result of
+ * \c "/test_bd/config" and \c "/test_bd//config_old" is \c "/test_bd". The output buffer shouldn't
+ * overlap with input paths.
+ *
+ * @param output_path output path buffer
+ * @param n length of output_path buffer
+ * @param paths paths
+ * @param count number of paths
+ * @return 0 on success, otherwise -1 and \c errno is set. \c EINVAL is set if \p count is 0, or absolute paths
+ *         are mixed with relative ones. \c ENOBUFS is set if the output buffer is too small.
+ */
+int commonpath(char *output_path, size_t n, const char *const *paths, size_t count);
+
+/**
+ * Get hash of the normalized path.
+ *
+ * The result is equal to hash of the \c normpath result, but the path isn't copied or modified:
+ * \c "/test_bd//config/./settings.txt" and \c "/test_bd/config/settings.txt" have the same hash.
+ * It's a polynomial hash, that is calculated 8 bytes per step for normalized paths.
+ *
+ * @param path
+ * @return hash value
+ */
+uint32_t path_hash(const char *path);
+
+/**
+ * Check if paths are equal after normalization, i.e. \c normpath gives the same results for them.
+ *
+ * Paths aren't copied or modified.
+ *
+ * @param path_a
+ * @param path_b
+ * @return true if paths are equal
+ */
+bool path_equal(const char *path_a, const char *path_b);
+
+/**
+ * Bump allocator, that allocates memory from a caller buffer.
+ *
+ * Allocated blocks aren't freed separately. All of them are released by \c reset.
+ */
+class PathArena {
+public:
+    /**
+     * Constructor.
+     *
+     * @param buff memory buffer
+     * @param size buffer size
+     */
+    PathArena(void *buff, size_t size)
+        : _buff((uint8_t *)buff)
+        , _size(size)
+        , _used(0)
+    {
+    }
+
+    /**
+     * Allocate memory block.
+     *
+     * @param size block size
+     * @param align block alignment. It should be power of 2.
+     * @return pointer to the block or \c NULL (\c errno is set to \c ENOBUFS), if the buffer is exhausted
+     */
+    void *allocate(size_t size, size_t align = sizeof(uint32_t));
+
+    /**
+     * Release all allocated blocks.
+     */
+    void reset()
+    {
+        _used = 0;
+    }
+
+    uint8_t *data() const
+    {
+        return _buff;
+    }
+
+    size_t used() const
+    {
+        return _used;
+    }
+
+    size_t capacity() const
+    {
+        return _size;
+    }
+
+private:
+    uint8_t *_buff;
+    size_t _size;
+    size_t _used;
+};
+
+/**
+ * Compact set of paths, that stores path components in a prefix tree.
+ *
+ * Each path component is stored once per parent directory in a \c PathArena, so paths with common prefixes
+ * share memory. Nodes reference each other by 32-bit offsets in the arena, so a node takes 16 bytes
+ * plus its name. Paths are normalized like \c normpath does, so \c "/a/./b" and \c "/a//b/" are the same path.
+ *
+ * Example:
+ *
+ * @code
+ * static uint8_t trie_buff[16 * 1024];
+ * PathArena arena(trie_buff, sizeof(trie_buff));
+ * PathTrie trie(arena);
+ * trie.insert("/test_bd/config/settings.txt");
+ * if (trie.lookup("/test_bd//config/settings.txt") == 0) {
+ *     // path is found
+ * }
+ * @endcode
+ */
+class PathTrie {
+public:
+    /**
+     * Node identifier, that is used to reconstruct path.
+     */
+    typedef uint32_t NodeId;
+
+    /**
+     * Callback of the paths enumeration.
+     *
+     * @param path path
+     * @param context user data
+     * @return 0 to continue enumeration, otherwise enumeration is stopped
+     */
+    typedef int (*Callback)(const char *path, void *context);
+
+    /**
+     * Constructor.
+     *
+     * @param arena arena, that is used to allocate nodes. It can be shared with other objects.
+     */
+    explicit PathTrie(PathArena &arena);
+
+    /**
+     * Add path.
+     *
+     * If the arena is exhausted, the path isn't added, but some of its parent nodes can be kept in the arena.
+     *
+     * @param path path
+     * @param id optional identifier of the path node
+     * @return 0 on success, otherwise -1 and \c errno is set (\c EINVAL for empty path, \c ENAMETOOLONG
+     *         if a path component is longer than 255 bytes, \c ENOBUFS if the arena is exhausted)
+     */
+    int insert(const char *path, NodeId *id = NULL);
+
+    /**
+     * Find path.
+     *
+     * @param path path
+     * @param id optional identifier of the path node
+     * @return 0 if path is found, otherwise -1 and \c errno is set to \c ENOENT
+     */
+    int lookup(const char *path, NodeId *id = NULL) const;
+
+    /**
+     * Reconstruct normalized path by its node identifier.
+     *
+     * @param id node identifier
+     * @param buff output buffer
+     * @param n size of the output buffer
+     * @return 0 on success, otherwise -1 and \c errno is set to \c ENOBUFS
+     */
+    int get_path(NodeId id, char *buff, size_t n) const;
+
+    /**
+     * Enumerate stored paths, that are equal to \p prefix or are inside it, in depth-first order.
+     *
+     * Enumeration doesn't use recursion or dynamic memory.
+     *
+     * @param prefix parent directory
+     * @param buff buffer for paths, that are passed to callback
+     * @param n size of the buffer
+     * @param callback callback
+     * @param context user data of the callback
+     * @return 0 on success, non-zero value of the callback, or -1 if the buffer is too small (\c errno is set to \c ENOBUFS)
+     */
+    int enumerate(const char *prefix, char *buff, size_t n, Callback callback, void *context = NULL) const;
+
+    /**
+     * Remove all paths.
+     *
+     * Memory of the nodes isn't reused until the arena is reset.
+     */
+    void clear();
+
+    /**
+     * Get number of stored paths.
+     */
+    size_t size() const
+    {
+        return _size;
+    }
+
+    /**
+     * Get number of nodes (unique path components).
+     */
+    size_t node_count() const
+    {
+        return _node_count;
+    }
+
+    /**
+     * Get arena memory, that is used by the nodes.
+     */
+    size_t memory_used() const
+    {
+        return _memory_used;
+    }
+
+private:
+    struct Node;
+
+    Node *get_node(NodeId id) const;
+    NodeId find_node(const char *path) const;
+    NodeId find_child(NodeId parent, const char *name, size_t len, uint16_t hash) const;
+    NodeId add_node(NodeId parent, const char *name, size_t len, uint16_t hash);
+
+    PathArena &_arena;
+    NodeId _abs_root;
+    NodeId _rel_root;
+    size_t _size;
+    size_t _node_count;
+    size_t _memory_used;
+};
+
+/**
+ * Path string of the fixed capacity, that can be built at compile time.
+ *
+ * It follows \c PathBufferBase interface, but all methods are \c constexpr and give the same results
+ * as the runtime \c join_paths, \c normpath and \c dirname functions. It's created by \c static_path,
+ * \c static_join_paths, \c static_normpath, \c static_dirname and \c static_basename functions:
+ *
+ * @code
+ * static constexpr auto CONFIG_PATH = static_normpath(static_join_paths("/test_bd", "config/"));
+ * static_assert(CONFIG_PATH.equals("/test_bd/config"), "");
+ * @endcode
+ *
+ * @tparam N buffer size including null terminator
+ */
+template <size_t N>
+class StaticPath {
+public:
+    constexpr StaticPath()
+        : _data(), _len(0)
+    {
+    }
+
+    constexpr const char *c_str() const
+    {
+        return _data;
+    }
+
+    constexpr size_t size() const
+    {
+        return _len;
+    }
+
+    static constexpr size_t capacity()
+    {
+        return N;
+    }
+
+    /**
+     * Compare path with string.
+     *
+     * @param path
+     * @return true if strings are equal
+     */
+    constexpr bool equals(const char *path) const
+    {
+        size_t i = 0;
+        while (i < _len && path[i] == _data[i]) {
+            i++;
+        }
+        return i == _len && path[i] == '\0';
+    }
+
+    /**
+     * Replace current path.
+     *
+     * @param path
+     * @return 0 on success, otherwise non-zero value (the buffer is too small)
+     */
+    constexpr int assign(const char *path)
+    {
+        size_t len = 0;
+        while (path[len] != '\0') {
+            if (len + 1 >= N) {
+                return -1;
+            }
+            len++;
+        }
+        for (size_t i = 0; i < len; i++) {
+            _data[i] = path[i];
+        }
+        _data[len] = '\0';
+        _len = len;
+        return 0;
+    }
+
+    /**
+     * Append part to current path like \c append_path does.
+     *
+     * @param path_r
+     * @return 0 on success, otherwise non-zero value (the buffer is too small)
+     */
+    constexpr int append(const char *path_r)
+    {
+        size_t pos = _len;
+        size_t len = 0;
+
+        if (path_r[0] == '/' || _len == 0) {
+            return assign(path_r);
+        }
+        if (_data[pos - 1] != '/') {
+            pos++;
+        }
+        while (path_r[len] != '\0') {
+            len++;
+        }
+        if (pos + len + 1 > N) {
+            return -1;
+        }
+        _data[pos - 1] = '/';
+        for (size_t i = 0; i <= len; i++) {
+            _data[pos + i] = path_r[i];
+        }
+        _len = pos + len;
+        return 0;
+    }
+
+    /**
+     * Normalize current path like \c normpath does.
+     *
+     * @return 0
+     */
+    constexpr int normalize()
+    {
+        // it's the same algorithm as normpath has, but with indices instead of pointers
+        ptrdiff_t pos = -1;
+        ptrdiff_t new_pos = 0;
+        ptrdiff_t prev_sep = -1;
+        ptrdiff_t prev_prev_sep = -1;
+        bool stop_flag = false;
+        bool abs_flag = _data[0] == '/';
+        char sym = '\0';
+
+        if (_len == 0) {
+            return 0;
+        }
+        while (!stop_flag) {
+            sym = _data[++pos];
+            if (sym == '\0') {
+                stop_flag = true;
+                sym = '/';
+            }
+            _data[new_pos] = sym;
+
+            if (sym == '/') {
+                if (new_pos - prev_sep == 1 && pos != 0) {
+                    // collapse separators
+                    new_pos -= 1;
+                } else if (new_pos - prev_sep == 2 && _data[new_pos - 1] == '.') {
+                    // collapse "/./"
+                    new_pos -= 2;
+                } else if (new_pos - prev_sep == 3 && _data[new_pos - 1] == '.' && _data[new_pos - 2] == '.') {
+                    if (prev_sep == 0) {
+                        // collapse "/../" to "/"
+                        new_pos = prev_sep;
+                    } else {
+                        prev_prev_sep = prev_sep - 1;
+                        while (prev_prev_sep >= 0 && _data[prev_prev_sep] != '/') {
+                            prev_prev_sep--;
+                        }
+                        if (prev_sep < 0) {
+                            // "../" - nothing to collapse
+                            prev_sep = new_pos;
+                        } else if (prev_sep - prev_prev_sep == 3 && _data[prev_sep - 1] == '.' && _data[prev_sep - 2] == '.') {
+                            // "../../" - nothing to collapse
+                            prev_sep = new_pos;
+                        } else {
+                            // collapse "<some_path>/abc/../" to "<some_path>/"
+                            prev_sep = prev_prev_sep;
+                            new_pos = prev_sep;
+                        }
+                    }
+                } else {
+                    prev_sep = new_pos;
+                }
+            }
+            new_pos++;
+        }
+
+        if (new_pos == 0) {
+            // path is reduced to empty path
+            _data[0] = '.';
+            _len = 1;
+        } else if (abs_flag && new_pos == 1) {
+            _data[0] = '/';
+            _len = 1;
+        } else {
+            // remove trailing "/"
+            _len = (size_t)new_pos - 1;
+        }
+        _data[_len] = '\0';
+        return 0;
+    }
+
+    /**
+     * Replace current path with its parent directory like \c dirname does.
+     *
+     * @return 0
+     */
+    constexpr int dirname()
+    {
+        ptrdiff_t pos = (ptrdiff_t)_len - 1;
+        while (pos >= 0 && _data[pos] != '/') {
+            pos--;
+        }
+        // remove multiple separators
+        while (pos > 0 && _data[pos - 1] == '/') {
+            pos--;
+        }
+        if (pos < 0) {
+            _len = 0;
+        } else if (pos == 0) {
+            _len = 1;
+        } else {
+            _len = (size_t)pos;
+        }
+        _data[_len] = '\0';
+        return 0;
+    }
+
+    /**
+     * Get base name of the current path.
+     *
+     * @return pointer to the last path part
+     */
+    constexpr const char *basename() const
+    {
+        size_t pos = _len;
+        while (pos > 0 && _data[pos - 1] != '/') {
+            pos--;
+        }
+        return _data + pos;
+    }
+
+private:
+    char _data[N];
+    size_t _len;
+};
+
+/**
+ * Buffer size, that is enough for a string literal or a \c StaticPath.
+ */
+template <typename T>
+struct StaticPathSize;
+
+template <size_t N>
+struct StaticPathSize<char[N]> {
+    static const size_t value = N;
+};
+
+template <size_t N>
+struct StaticPathSize<StaticPath<N> > {
+    static const size_t value = N;
+};
+
+inline constexpr const char *static_path_str(const char *path)
+{
+    return path;
+}
+
+template <size_t N>
+inline constexpr const char *static_path_str(const StaticPath<N> &path)
+{
+    return path.c_str();
+}
+
+/**
+ * Create \c StaticPath from string literal.
+ *
+ * @param path string literal or \c StaticPath
+ * @return path
+ */
+template <typename T>
+inline constexpr StaticPath<StaticPathSize<T>::value> static_path(const T &path)
+{
+    StaticPath<StaticPathSize<T>::value> result;
+    result.assign(static_path_str(path));
+    return result;
+}
+
+/**
+ * Compile time version of \c join_paths.
+ *
+ * @param path_l left part of path (string literal or \c StaticPath)
+ * @param path_r right part of path (string literal or \c StaticPath)
+ * @return joined path
+ */
+template <typename L, typename R>
+inline constexpr StaticPath<StaticPathSize<L>::value + StaticPathSize<R>::value> static_join_paths(const L &path_l, const R &path_r)
+{
+    StaticPath<StaticPathSize<L>::value + StaticPathSize<R>::value> result;
+    result.assign(static_path_str(path_l));
+    result.append(static_path_str(path_r));
+    return result;
+}
+
+/**
+ * Compile time version of \c normpath.
+ *
+ * @param path string literal or \c StaticPath
+ * @return normalized path
+ */
+template <typename T>
+inline constexpr StaticPath<StaticPathSize<T>::value> static_normpath(const T &path)
+{
+    StaticPath<StaticPathSize<T>::value> result;
+    result.assign(static_path_str(path));
+    result.normalize();
+    return result;
+}
+
+/**
+ * Compile time version of \c dirname.
+ *
+ * @param path string literal or \c StaticPath
+ * @return parent directory name
+ */
+template <typename T>
+inline constexpr StaticPath<StaticPathSize<T>::value> static_dirname(const T &path)
+{
+    StaticPath<StaticPathSize<T>::value> result;
+    result.assign(static_path_str(path));
+    result.dirname();
+    return result;
+}
+
+/**
+ * Compile time version of \c basename.
+ *
+ * @param path string literal or \c StaticPath
+ * @return base name of the path
+ */
+template <typename T>
+inline constexpr StaticPath<StaticPathSize<T>::value> static_basename(const T &path)
+{
+    StaticPath<StaticPathSize<T>::value> result;
+    result.assign(static_path_str(path));
+    result.assign(result.basename());
+    return result;
+}
+
 /**
  * Check if a \p name is name of the subdirectory of file in the directory.
  *
@@ -200,6 +2146,261 @@ bool is_child_dirent(struct dirent *dir_ent);
  */
 struct dirent *readdir_child(DIR *dirp);
 
+/**
+ * Compiled shell-style pattern.
+ *
+ * Supported syntax:
+ *
+ * - \c "*" matches any sequence of characters except separator;
+ * - \c "?" matches any character except separator;
+ * - \c "[abc]", \c "[a-z]", \c "[!a-z]" match one character of the class (or not in class) except separator;
+ * - \c "**" as a whole path component matches zero or more path components, so the pattern with components
+ *   \c "**", \c "tmp" and \c "*" matches both \c "tmp/a.log" and \c "var/tmp/a.log";
+ * - \c "\\" escapes the next character.
+ *
+ * Leading dots of the names aren't special. The pattern is analyzed once, so names are checked without
+ * memory allocations: patterns without wildcards are compared by \c memcmp, literal prefix and suffix
+ * of the pattern (e.g. \c "cfg_" and \c ".bin" of the \c "cfg_??.bin") are compared before other elements.
+ *
+ * Example:
+ *
+ * @code
+ * GlobPattern pattern;
+ * pattern.compile("*.log");
+ * while ((dir_ent = readdir_match(dir, pattern)) != NULL) {
+ *     // process log file
+ * }
+ * @endcode
+ */
+class GlobPattern {
+public:
+    GlobPattern();
+
+    /**
+     * Compile pattern.
+     *
+     * The pattern string isn't copied, so it should be valid while the object is used.
+     *
+     * @param pattern pattern
+     * @return 0 on success, otherwise -1 and \c errno is set to \c EINVAL (pattern ends with unescaped "\\")
+     */
+    int compile(const char *pattern);
+
+    /**
+     * Check if name or path matches the pattern.
+     *
+     * @param name name or path
+     * @return true if name matches the pattern, false if it doesn't match or pattern isn't compiled
+     */
+    bool match(const char *name) const
+    {
+        return match(name, strlen(name));
+    }
+
+    /**
+     * Check if name or path matches the pattern.
+     *
+     * @param name name or path. It may not be null terminated.
+     * @param len name length
+     * @return true if name matches the pattern, false if it doesn't match or pattern isn't compiled
+     */
+    bool match(const char *name, size_t len) const;
+
+    /**
+     * Get pattern string.
+     */
+    const char *pattern() const
+    {
+        return _pattern;
+    }
+
+private:
+    enum Kind {
+        // pattern isn't compiled
+        KIND_NONE,
+        // pattern without special characters
+        KIND_LITERAL,
+        // literal prefix, one '*' and literal suffix
+        KIND_STAR,
+        // other patterns
+        KIND_GENERAL
+    };
+
+    bool match_general(const char *name, size_t len) const;
+
+    const char *_pattern;
+    size_t _len;
+    size_t _prefix_len;
+    size_t _suffix_len;
+    // minimal length of the matched name
+    size_t _min_len;
+    Kind _kind;
+};
+
+/**
+ * Check if name or path matches shell-style pattern.
+ *
+ * It compiles pattern for each call. Use \c GlobPattern to check many names.
+ *
+ * @param pattern pattern (see \c GlobPattern for syntax)
+ * @param name name or path
+ * @return true if name matches the pattern, false if it doesn't match or pattern is invalid
+ */
+bool fnmatch(const char *pattern, const char *name);
+
+/**
+ * Helper wrapper around \c readdir, that returns only children, whose names match the \p pattern.
+ *
+ * Names are matched directly in the \c dirent structure.
+ *
+ * @param dirp
+ * @param pattern compiled pattern
+ * @return directory entry or \c NULL if there are no more matched entries or on error
+ */
+struct dirent *readdir_match(DIR *dirp, const GlobPattern &pattern);
+
+/**
+ * Sort order of the directory listing.
+ */
+enum DirSortOrder {
+    // order of the readdir results
+    DIR_SORT_NONE,
+    // names in the \c strcmp order
+    DIR_SORT_NAME,
+    // directories before other entries, each group is sorted by name
+    DIR_SORT_DIRS_FIRST
+};
+
+/**
+ * Entry of the directory listing.
+ *
+ * Entries are packed in a \c PathArena with their names right after them.
+ */
+struct DirEntry {
+    // cached information of the entry. It's valid if \c info_flag is set (see \c DirListing::info).
+    PathInfo info;
+    uint16_t name_len;
+    // entry type (DT_DIR, DT_REG, DT_LNK, etc.)
+    unsigned char type;
+    bool info_flag;
+
+    const char *name() const
+    {
+        return (const char *)(this + 1);
+    }
+};
+
+/**
+ * Directory listing, that is stored in a caller arena.
+ *
+ * Entry names and types are taken from \c readdir results. Entry information (size and modification time) is
+ * got on demand by \c info method and is cached in the entry. On host builds the directory is kept opened,
+ * so information is got relative to it (\c fstatat) without resolution of the full path.
+ *
+ * Example:
+ *
+ * @code
+ * static uint8_t arena_buff[2048];
+ * PathArena arena(arena_buff, sizeof(arena_buff));
+ * DirListing listing;
+ * if (scandir("/fs/logs", listing, arena, DIR_SORT_NAME) == 0) {
+ *     for (size_t i = 0; i < listing.size(); i++) {
+ *         printf("%s %lu\n", listing[i].name(), (unsigned long)listing.info(i).size);
+ *     }
+ * }
+ * listing.close();
+ * @endcode
+ */
+class DirListing {
+public:
+    DirListing();
+    ~DirListing();
+
+    /**
+     * Read directory entries.
+     *
+     * Previous listing is closed, but its entries aren't released from its arena.
+     * If the function fails, the arena can contain part of the entries.
+     *
+     * @param path directory path
+     * @param arena arena to store entries. It can be shared with other objects.
+     * @param order sort order
+     * @param pattern optional pattern, that entry names should match
+     * @return 0 on success, otherwise -1 and \c errno is set (\c ENOBUFS if the arena is exhausted)
+     */
+    int scan(const char *path, PathArena &arena, DirSortOrder order = DIR_SORT_NONE, const GlobPattern *pattern = NULL);
+
+    /**
+     * Release directory.
+     *
+     * Entries and their cached information are available until the arena is reset,
+     * but information of the other entries can't be got.
+     *
+     * @return 0 on success, otherwise non-zero value
+     */
+    int close();
+
+    /**
+     * Get number of entries.
+     */
+    size_t size() const
+    {
+        return _size;
+    }
+
+    /**
+     * Get entry.
+     */
+    DirEntry &operator[](size_t i) const
+    {
+        return *_entries[i];
+    }
+
+    /**
+     * Get entry information.
+     *
+     * The first call gets information by \c stat (symbolic links are followed like \c path_info does)
+     * and caches it in the entry. Unlike other functions, it doesn't modify \c errno. Error code is stored
+     * in the \c PathInfo::error field.
+     *
+     * @param i entry index
+     * @return entry information
+     */
+    const PathInfo &info(size_t i);
+
+private:
+    // copy isn't allowed
+    DirListing(const DirListing &);
+    DirListing &operator=(const DirListing &);
+
+    DIR *_dir;
+    // directory path with space for entry names
+    char *_path;
+    size_t _path_len;
+    bool _opened;
+
+    DirEntry **_entries;
+    size_t _size;
+};
+
+/**
+ * Read directory entries.
+ *
+ * It's the same as \c DirListing::scan.
+ *
+ * @param path directory path
+ * @param listing listing
+ * @param arena arena to store entries
+ * @param order sort order
+ * @param pattern optional pattern, that entry names should match
+ * @return 0 on success, otherwise -1 and \c errno is set (\c ENOBUFS if the arena is exhausted)
+ */
+inline int scandir(const char *path, DirListing &listing, PathArena &arena, DirSortOrder order = DIR_SORT_NONE,
+                   const GlobPattern *pattern = NULL)
+{
+    return listing.scan(path, arena, order, pattern);
+}
+
 /**
  * Write data to file.
  *
@@ -250,5 +2451,237 @@ int write_str(const char *path, const char *text);
  * @return real string length, or negative value on error of if buffer is too small
  */
 int read_str(const char *path, char *text, size_t len);
+
+/**
+ * Pull-style reader of a file by chunks.
+ *
+ * It reads a file or its window, that is set by an offset and a length, into a caller buffer, so files, that are
+ * larger than available RAM, can be processed by one small buffer. Short reads of the file system are continued,
+ * so each \c read call fills the whole buffer except the end of the window.
+ *
+ * Example:
+ *
+ * @code
+ * uint8_t buf[512];
+ * ssize_t len;
+ * FileReader reader;
+ * if (reader.open("/fs/firmware.bin", 1024)) {
+ *     // process error
+ * }
+ * while ((len = reader.read(buf, sizeof(buf))) > 0) {
+ *     // process data
+ * }
+ * reader.close();
+ * @endcode
+ */
+class FileReader {
+public:
+    FileReader();
+    ~FileReader();
+
+    /**
+     * Open file.
+     *
+     * If another file is opened, it's closed. The window is limited by the file size, so the window,
+     * that starts after the end of the file, is empty.
+     *
+     * @param path file path
+     * @param offset offset of the window
+     * @param length length of the window. If it's negative, the window lasts until the end of the file.
+     * @return 0 on success, otherwise -1 and \c errno is set
+     */
+    int open(const char *path, off_t offset = 0, off_t length = -1);
+
+    /**
+     * Read next chunk.
+     *
+     * @param buf buffer for data
+     * @param len buffer length
+     * @return number of read bytes, that is less than \p len only at the end of the window,
+     *         0 if the window has been read, or -1 on error (\c errno is set)
+     */
+    ssize_t read(uint8_t *buf, size_t len);
+
+    /**
+     * Close file.
+     *
+     * @return 0 on success, otherwise non-zero value
+     */
+    int close();
+
+    /**
+     * Check if file is opened.
+     */
+    bool is_open() const
+    {
+        return _file >= 0;
+    }
+
+    /**
+     * Get window length.
+     */
+    off_t size() const
+    {
+        return _size;
+    }
+
+    /**
+     * Get number of bytes, that have been read from the window.
+     */
+    off_t position() const
+    {
+        return _pos;
+    }
+
+private:
+    // copy isn't allowed
+    FileReader(const FileReader &);
+    FileReader &operator=(const FileReader &);
+
+    int _file;
+    off_t _size;
+    off_t _pos;
+};
+
+/**
+ * Callback of the chunked file reading.
+ *
+ * @param data chunk data
+ * @param len chunk length
+ * @param offset chunk offset relative to the beginning of the window
+ * @param context user data
+ * @return 0 to continue reading, positive value to stop it, or -1 to stop it with error
+ */
+typedef int (*ReadChunkCallback)(const uint8_t *data, size_t len, off_t offset, void *context);
+
+/**
+ * Read file by chunks.
+ *
+ * It's a callback version of the \c FileReader. Each chunk, except the last one, has \p buf_len length.
+ * Empty window doesn't produce callback calls.
+ *
+ * @param path file path
+ * @param buf buffer for chunks
+ * @param buf_len buffer length
+ * @param callback callback, that is called for each chunk
+ * @param context user data of the callback
+ * @param offset offset of the window
+ * @param length length of the window. If it's negative, the window lasts until the end of the file.
+ * @return 0 on success, positive value of the callback if reading is stopped by it, or -1 on error (\c errno is set)
+ */
+int read_chunks(const char *path, uint8_t *buf, size_t buf_len, ReadChunkCallback callback, void *context = NULL,
+                off_t offset = 0, off_t length = -1);
+
+/**
+ * Expected access pattern of the mapped file.
+ */
+enum MapAccess {
+    // default read-ahead of the system
+    MAP_ACCESS_NORMAL,
+    // file is read from the beginning to the end, so aggressive read-ahead is used
+    MAP_ACCESS_SEQUENTIAL,
+    // file is read in random order, so read-ahead is disabled
+    MAP_ACCESS_RANDOM
+};
+
+/**
+ * Read-only file content in memory.
+ *
+ * If \c PATHUTIL_USE_MMAP is enabled, the file is mapped by \c mmap, so its data isn't copied, and the access pattern
+ * is passed to the system by \c madvise. Otherwise or if the file can't be mapped, it's read to a dynamically
+ * allocated buffer by \c read_data, so the class can be used unconditionally.
+ *
+ * The object owns the mapping or the buffer. It can be moved, but can't be copied.
+ *
+ * Example:
+ *
+ * @code
+ * MappedFile file = map_file("/tmp/manifest.bin", MAP_ACCESS_SEQUENTIAL);
+ * if (!file.is_open()) {
+ *     // process error
+ * }
+ * parse(file.data(), file.size());
+ * @endcode
+ */
+class MappedFile {
+public:
+    MappedFile();
+    MappedFile(MappedFile &&other);
+    MappedFile &operator=(MappedFile &&other);
+    ~MappedFile();
+
+    /**
+     * Map file.
+     *
+     * If another file is opened, it's closed.
+     *
+     * @param path file path
+     * @param access expected access pattern
+     * @return 0 on success, otherwise -1 and \c errno is set
+     */
+    int open(const char *path, MapAccess access = MAP_ACCESS_NORMAL);
+
+    /**
+     * Release file data.
+     *
+     * @return 0 on success, otherwise non-zero value
+     */
+    int close();
+
+    /**
+     * Check if file is opened.
+     */
+    bool is_open() const
+    {
+        return _open;
+    }
+
+    /**
+     * Check if file is mapped by \c mmap, otherwise its data is copied to a buffer.
+     */
+    bool is_mapped() const
+    {
+        return _mapped;
+    }
+
+    /**
+     * Get file data. It's \c NULL for empty files.
+     */
+    const uint8_t *data() const
+    {
+        return _data;
+    }
+
+    /**
+     * Get file size.
+     */
+    size_t size() const
+    {
+        return _size;
+    }
+
+private:
+    // copy isn't allowed
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    int read_file(const char *path, size_t size);
+
+    uint8_t *_data;
+    size_t _size;
+    bool _open;
+    bool _mapped;
+};
+
+/**
+ * Map file to memory.
+ *
+ * It's the same as \c MappedFile::open, but returns the object. On error the object isn't opened and \c errno is set.
+ *
+ * @param path file path
+ * @param access expected access pattern
+ * @return mapped file
+ */
+MappedFile map_file(const char *path, MapAccess access = MAP_ACCESS_NORMAL);
 }
 #endif // PATHUTIL_H
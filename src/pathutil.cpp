@@ -1,293 +1,1977 @@
 ﻿#include "string.h"
 
 #include "pathutil.h"
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 using namespace pathutil;
 
 #define SEP '/'
 
-static int rmtree_recursive_impl(char *path_buff, size_t path_len, size_t buff_len, bool remove_dir = true)
+#define DEFAULT_RMTREE_BUFF_SIZE 256
+
+//--------------------------------------------------------------------------------
+// TreeWalker
+//
+// The walker doesn't use recursion, so its stack usage doesn't depend on a tree depth. The traversal state
+// consists of the current path, that is stored in a caller buffer, and handles of the opened directories.
+// Only handles of the last max_open_dirs levels are kept opened. If the walker returns to a level,
+// whose handle has been closed, the directory is opened again and the already read entries are skipped.
+// Their numbers are stored at the end of the caller buffer. If the caller removes each reported entry,
+// the directory reading can be simply started from the beginning.
+//
+// If PATHUTIL_USE_AT_FUNCTIONS is enabled, subdirectories are opened relative to the opened parent directory
+// handles (openat), so the file system doesn't resolve a full path for each directory, and the parent
+// directory descriptor is passed to the caller for the same purpose.
+//--------------------------------------------------------------------------------
+
+/**
+ * Get entry type by its mode.
+ */
+static unsigned char mode_to_type_impl(mode_t mode)
+{
+    if (S_ISDIR(mode)) {
+        return DT_DIR;
+    } else if (S_ISREG(mode)) {
+        return DT_REG;
+    } else if (S_ISLNK(mode)) {
+        return DT_LNK;
+    } else {
+        return DT_UNKNOWN;
+    }
+}
+
+/**
+ * Call \c lstat for the entry of the directory, that is opened as \p dir_fd (if it isn't negative).
+ */
+static int lstat_entry_impl(int dir_fd, const char *path, const char *name, struct stat *st)
+{
+#if PATHUTIL_USE_AT_FUNCTIONS
+    if (dir_fd >= 0) {
+        return fstatat(dir_fd, name, st, AT_SYMLINK_NOFOLLOW);
+    }
+#else
+    (void)dir_fd;
+    (void)name;
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+    return lstat(path, st);
+#else
+    // mbed-os file systems don't support symbolic links
+    return stat(path, st);
+#endif
+}
+
+#if PATHUTIL_USE_AT_FUNCTIONS
+/**
+ * Open directory, that is used only as a base of the *at calls.
+ *
+ * Such calls require only search permission of the directory, so it's opened with \c O_PATH or \c O_SEARCH
+ * flag, if it's available. Otherwise directory without read permission can't be opened.
+ */
+static int open_base_dir_impl(const char *path)
+{
+#if defined(O_PATH)
+    return open(path, O_PATH | O_DIRECTORY | O_CLOEXEC);
+#elif defined(O_SEARCH)
+    return open(path, O_SEARCH | O_DIRECTORY | O_CLOEXEC);
+#else
+    return open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+#endif
+}
+#endif
+
+TreeWalker::TreeWalker(size_t max_open_dirs)
+    : _state(STATE_IDLE)
+    , _pending(PENDING_NONE)
+    , _path(NULL)
+    , _path_len(0)
+    , _entry_len(0)
+    , _root_len(0)
+    , _buff_len(0)
+    , _max_depth(0)
+    , _removing(false)
+    , _depth(0)
+    , _open_depth(0)
+    , _opened(false)
+{
+    if (max_open_dirs == 0 || max_open_dirs > PATHUTIL_RMTREE_MAX_OPEN_DIRS) {
+        max_open_dirs = PATHUTIL_RMTREE_MAX_OPEN_DIRS;
+    }
+    _max_open_dirs = max_open_dirs;
+}
+
+TreeWalker::~TreeWalker()
+{
+    cancel();
+}
+
+int TreeWalker::start(const char *path, char *buff, size_t buff_len, size_t max_depth, bool removing)
 {
+    int origin_errno = errno;
+    size_t path_len = strlen(path);
     DIR *dir;
-    struct dirent *dir_entity;
+
+    if (cancel()) {
+        return -1;
+    }
+    if (buff == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    _path = buff;
+    _buff_len = buff_len;
+    _removing = removing;
+    _depth = 0;
+    // check that buffer can store root path and numbers of the read entries
+    if (path_len + 1 > path_capacity()) {
+        errno = ENOBUFS;
+        return -1;
+    }
+    memmove(_path, path, path_len + 1);
+    _path_len = path_len;
+    _entry_len = path_len;
+    _root_len = path_len;
+    _max_depth = max_depth;
+
+    // open root directory
+    if ((dir = opendir(_path)) == NULL) {
+        _state = STATE_FAILED;
+        return -1;
+    }
+    _dirs[0] = dir;
+    _open_depth = 0;
+    _opened = true;
+    *position_at(0) = 0;
+    _pending = PENDING_ROOT;
+    _state = STATE_RUNNING;
+
+    errno = origin_errno;
+    return 0;
+}
+
+int TreeWalker::next(WalkEntry *entry)
+{
+    int origin_errno = errno;
     int ret_code = 0;
-    int tmp_ret_code;
-    int origin_errno;
-    size_t sub_path_len;
-    uint8_t de_type;
 
-    if ((dir = opendir(path_buff)) == NULL) {
+    if (_state != STATE_RUNNING) {
+        if (_state == STATE_DONE) {
+            return 0;
+        }
+        errno = EINVAL;
         return -1;
     }
 
-    origin_errno = errno;
-    errno = 0;
-    // remove directory content
-    while ((dir_entity = readdir(dir)) != NULL) {
+    switch (_pending) {
+    case PENDING_ROOT:
+        // root directory is already opened
+        fill_entry(entry, WALK_PRE_DIR, DT_DIR, 0, -1, NULL);
+        _pending = PENDING_NONE;
+        errno = origin_errno;
+        return 1;
+    case PENDING_ENTER:
+        if (_max_depth == 0 || _depth + 1 < _max_depth) {
+            ret_code = enter_dir();
+        } else {
+            _path[_path_len] = '\0';
+        }
+        break;
+    case PENDING_POP:
+        _path[_path_len] = '\0';
+        break;
+    case PENDING_FINISH:
+        _state = STATE_DONE;
+        return 0;
+    default:
+        break;
+    }
+    _pending = PENDING_NONE;
+    _entry_len = _path_len;
+
+    if (!ret_code) {
+        ret_code = read_entry(entry);
+    }
+    if (ret_code < 0) {
+        if (!errno) {
+            errno = EIO;
+        }
+        origin_errno = errno;
+        close_all();
+        _state = STATE_FAILED;
+    }
+    errno = origin_errno;
+    return ret_code;
+}
+
+void TreeWalker::skip_dir()
+{
+    if (_state != STATE_RUNNING) {
+        return;
+    }
+    if (_pending == PENDING_ENTER) {
+        _pending = PENDING_POP;
+    } else if (_pending == PENDING_NONE && _entry_len == _root_len && _depth == 0) {
+        // root directory
+        _pending = PENDING_FINISH;
+        close_all();
+    }
+}
+
+int TreeWalker::cancel()
+{
+    int ret_code = close_all();
+    if (_state == STATE_RUNNING) {
+        _state = STATE_IDLE;
+    }
+    return ret_code;
+}
+
+uint32_t *TreeWalker::position_at(size_t depth)
+{
+    uint32_t *end = (uint32_t *)((uintptr_t)(_path + _buff_len) & ~(uintptr_t)(sizeof(uint32_t) - 1));
+    return end - depth - 1;
+}
+
+size_t TreeWalker::path_capacity()
+{
+    if (_removing) {
+        return _buff_len;
+    }
+    // reserve space for the current level and the next one
+    char *positions = (char *)position_at(_depth + 1);
+    return positions > _path ? positions - _path : 0;
+}
+
+int TreeWalker::current_dir_fd()
+{
+#if PATHUTIL_USE_AT_FUNCTIONS
+    return dirfd(current_dir());
+#else
+    return -1;
+#endif
+}
+
+void TreeWalker::fill_entry(WalkEntry *entry, WalkEvent event, unsigned char type, size_t depth, int dir_fd, const struct stat *st)
+{
+    entry->event = event;
+    entry->type = type;
+    entry->depth = depth;
+    entry->path = _path;
+    entry->path_len = _entry_len;
+    entry->name = _path + _entry_len;
+    while (entry->name > _path + _root_len && entry->name[-1] != SEP) {
+        entry->name--;
+    }
+    if (depth == 0) {
+        entry->name = _path;
+    }
+    entry->dir_fd = dir_fd;
+    entry->stat = st;
+}
+
+int TreeWalker::read_entry(WalkEntry *entry)
+{
+    struct dirent *dir_entity;
+    unsigned char type;
+    const struct stat *st = NULL;
+    int dir_fd;
+
+    do {
+        // note: successful calls may change errno, so it should be reset before each readdir call
+        // to distinguish the end of the directory and an error
+        errno = 0;
+        if ((dir_entity = readdir(current_dir())) == NULL) {
+            return errno ? -1 : leave_dir(entry);
+        }
+        if (!_removing) {
+            (*position_at(_depth))++;
+        }
         // ignore special entries "." and ".."
-        if (!is_child_dirent(dir_entity->d_name)) {
-            continue;
+    } while (!is_child_dirent(dir_entity->d_name));
+
+    if (push_name(dir_entity->d_name)) {
+        return -1;
+    }
+    type = dir_entity->d_type;
+    dir_fd = current_dir_fd();
+    if (type == DT_UNKNOWN) {
+        // some file systems don't provide entry type
+        if (lstat_entry_impl(dir_fd, _path, _path + _path_len + 1, &_stat)) {
+            return -1;
+        }
+        type = mode_to_type_impl(_stat.st_mode);
+        st = &_stat;
+    }
+
+    if (type == DT_DIR) {
+        fill_entry(entry, WALK_PRE_DIR, type, _depth + 1, dir_fd, st);
+        _pending = PENDING_ENTER;
+    } else {
+        fill_entry(entry, WALK_FILE, type, _depth + 1, dir_fd, st);
+        _pending = PENDING_POP;
+    }
+    return 1;
+}
+
+int TreeWalker::push_name(const char *name)
+{
+    size_t name_len = strlen(name);
+    // check that buffer can store full path of directory entry
+    if (_path_len + name_len + 2 > path_capacity()) {
+        errno = ENOBUFS;
+        return -1;
+    }
+    _path[_path_len] = SEP;
+    memcpy(_path + _path_len + 1, name, name_len + 1);
+    _entry_len = _path_len + name_len + 1;
+    return 0;
+}
+
+DIR *TreeWalker::open_child_dir()
+{
+#if PATHUTIL_USE_AT_FUNCTIONS
+    if (_opened) {
+        int fd;
+        DIR *dir;
+        fd = openat(dirfd(current_dir()), _path + _path_len + 1, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd < 0) {
+            return NULL;
+        }
+        if ((dir = fdopendir(fd)) == NULL) {
+            close(fd);
+        }
+        return dir;
+    }
+#endif
+    return opendir(_path);
+}
+
+int TreeWalker::enter_dir()
+{
+    DIR *dir;
+    // release the most top directory, if the limit of opened directories is reached.
+    // note: the current directory is released only if one directory can be opened at the moment
+    if (_depth + 1 - _open_depth >= _max_open_dirs) {
+        if (closedir(dir_at(_open_depth))) {
+            _open_depth++;
+            _opened = _open_depth <= _depth;
+            return -1;
+        }
+        _open_depth++;
+        _opened = _open_depth <= _depth;
+    }
+    if ((dir = open_child_dir()) == NULL) {
+        return -1;
+    }
+    _depth++;
+    dir_at(_depth) = dir;
+    if (!_opened) {
+        _open_depth = _depth;
+        _opened = true;
+    }
+    _path_len = _entry_len;
+    if (!_removing) {
+        *position_at(_depth) = 0;
+    }
+    return 0;
+}
+
+int TreeWalker::leave_dir(WalkEntry *entry)
+{
+    DIR *dir;
+    int ret_code;
+    size_t dir_len = _path_len;
+    size_t pos;
+    char pos_char;
+
+    // directory content has been read
+    ret_code = closedir(current_dir());
+    if (_depth == _open_depth) {
+        _opened = false;
+    }
+    if (ret_code) {
+        if (_depth > _open_depth) {
+            _depth--;
         }
-        // delete content
-        de_type = dir_entity->d_type;
-        sub_path_len = path_len + strlen(dir_entity->d_name) + 1;
-        // check that buffer can store full path of directory entry
-        if (sub_path_len + 1 > buff_len) {
+        return -1;
+    }
+
+    if (_depth == 0) {
+        fill_entry(entry, WALK_POST_DIR, DT_DIR, 0, -1, NULL);
+        _pending = PENDING_FINISH;
+        return 1;
+    }
+
+    // go to the parent directory
+    pos = _path_len;
+    while (pos > _root_len && _path[pos] != SEP) {
+        pos--;
+    }
+    pos_char = _path[pos];
+    _path[pos] = '\0';
+    _path_len = pos;
+    _depth--;
+
+    // reopen parent directory, if it has been closed
+    if (!_opened) {
+        if ((dir = opendir(_path)) == NULL) {
+            return -1;
+        }
+        dir_at(_depth) = dir;
+        _open_depth = _depth;
+        _opened = true;
+        if (!_removing) {
+            // skip the already read entries
+            for (uint32_t i = *position_at(_depth); i > 0; i--) {
+                errno = 0;
+                if (readdir(dir) == NULL) {
+                    if (errno) {
+                        return -1;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    // restore directory path to report it
+    _path[pos] = pos_char;
+    _entry_len = dir_len;
+    fill_entry(entry, WALK_POST_DIR, DT_DIR, _depth + 1, current_dir_fd(), NULL);
+    _pending = PENDING_POP;
+    return 1;
+}
+
+int TreeWalker::close_all()
+{
+    int ret_code = 0;
+    if (_opened) {
+        for (size_t depth = _open_depth; depth <= _depth; depth++) {
+            if (closedir(dir_at(depth)) && !ret_code) {
+                ret_code = -1;
+            }
+        }
+        _opened = false;
+    }
+    return ret_code;
+}
+
+int pathutil::walk(const char *path, WalkCallback callback, void *context, char *buff, size_t buff_len, size_t max_depth,
+                   size_t max_open_dirs)
+{
+    TreeWalker walker(max_open_dirs);
+    WalkEntry entry;
+    int ret_code;
+    int error;
+
+    if (walker.start(path, buff, buff_len, max_depth)) {
+        return -1;
+    }
+    while ((ret_code = walker.next(&entry)) > 0) {
+        ret_code = callback(entry, context);
+        if (ret_code == WALK_SKIP) {
+            walker.skip_dir();
+        } else if (ret_code != WALK_CONTINUE) {
+            // keep error of the callback
+            error = errno;
+            walker.cancel();
+            errno = error;
+            return ret_code == WALK_STOP ? WALK_STOP : -1;
+        }
+    }
+    return ret_code;
+}
+
+//--------------------------------------------------------------------------------
+// TreeRemover
+//
+// The remover processes entries of the TreeWalker. Files are removed as they are reported, and directories
+// are removed after their content. As all processed entries have been already deleted, the walker reads
+// reopened directories from the beginning.
+//
+// If PATHUTIL_USE_AT_FUNCTIONS is enabled, entries are removed relative to the opened directory
+// handles (unlinkat), so the file system doesn't resolve a full path for each entry.
+// Otherwise each entry is removed by its full path.
+//--------------------------------------------------------------------------------
+
+/**
+ * Remove entry of the tree.
+ */
+static int remove_entry_impl(const WalkEntry &entry)
+{
+#if PATHUTIL_USE_AT_FUNCTIONS
+    if (entry.dir_fd >= 0) {
+        return unlinkat(entry.dir_fd, entry.name, entry.type == DT_DIR ? AT_REMOVEDIR : 0);
+    }
+#endif
+    return remove(entry.path);
+}
+
+TreeRemover::TreeRemover(size_t max_open_dirs)
+    : _state(STATE_IDLE)
+    , _walker(max_open_dirs)
+    , _path(NULL)
+    , _root_len(0)
+    , _cleanup_buff(false)
+    , _remove_root(true)
+    , _count_bytes(false)
+    , _entries_removed(0)
+    , _bytes_freed(0)
+{
+}
+
+TreeRemover::~TreeRemover()
+{
+    cancel();
+}
+
+int TreeRemover::start(const char *path, bool remove_root, bool count_bytes, char *buff, size_t buff_len)
+{
+    int origin_errno = errno;
+    size_t path_len = strlen(path);
+
+    if (cancel()) {
+        return -1;
+    }
+
+    if (buff == NULL) {
+        // check that buffer can store current path
+        if (path_len + 1 > DEFAULT_RMTREE_BUFF_SIZE) {
             errno = ENOBUFS;
-            ret_code = -1;
-            break;
+            return -1;
         }
-        path_buff[path_len] = SEP;
-        strcpy(path_buff + path_len + 1, dir_entity->d_name);
-        path_buff[sub_path_len] = '\0';
-        // remove directory item
-        switch (de_type) {
-        case DT_DIR:
-            ret_code = rmtree_recursive_impl(path_buff, sub_path_len, buff_len);
-            break;
-        case DT_REG:
-        case DT_LNK:
-            ret_code = remove(path_buff);
+        buff = new char[DEFAULT_RMTREE_BUFF_SIZE];
+        buff_len = DEFAULT_RMTREE_BUFF_SIZE;
+        _cleanup_buff = true;
+    } else {
+        // check that buffer can store current path
+        if (path_len + 1 > buff_len) {
+            errno = ENOBUFS;
+            return -1;
+        }
+    }
+    strcpy(buff, path);
+    stat_cache_invalidate(buff);
+
+    _path = buff;
+    _root_len = path_len;
+    _remove_root = remove_root;
+    _count_bytes = count_bytes;
+    _entries_removed = 0;
+    _bytes_freed = 0;
+
+    if (_walker.start(buff, buff, buff_len, 0, true)) {
+        release_buff();
+        _state = STATE_FAILED;
+        return -1;
+    }
+    _state = STATE_RUNNING;
+
+    errno = origin_errno;
+    return 0;
+}
+
+int TreeRemover::step(size_t max_entries, uint32_t max_time_us)
+{
+    int ret_code;
+    int origin_errno = errno;
+    size_t entries_limit = _entries_removed + max_entries;
+    uint32_t start_time = 0;
+
+    if (_state != STATE_RUNNING) {
+        if (_state == STATE_DONE) {
+            return 0;
+        }
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (max_time_us) {
+        start_time = us_ticker_read();
+    }
+    while ((ret_code = next()) > 0) {
+        if (max_entries && _entries_removed >= entries_limit) {
             break;
-        default:
-            // unsupported type
-            errno = EPERM;
-            ret_code = -1;
+        }
+        if (max_time_us && us_ticker_read() - start_time >= max_time_us) {
             break;
         }
     }
-    // "restore" buffer
-    path_buff[path_len] = '\0';
-    if (errno == 0) {
+
+    if (ret_code > 0) {
         errno = origin_errno;
-    } else {
+        return 1;
+    }
+    if (_walker.cancel() && !ret_code) {
         ret_code = -1;
     }
+    release_buff();
+    if (ret_code) {
+        if (!errno) {
+            errno = EIO;
+        }
+        _state = STATE_FAILED;
+        return -1;
+    }
+    _state = STATE_DONE;
+    errno = origin_errno;
+    return 0;
+}
+
+int TreeRemover::cancel()
+{
+    int ret_code = _walker.cancel();
+    release_buff();
+    if (_state == STATE_RUNNING) {
+        _state = STATE_IDLE;
+    }
+    return ret_code;
+}
+
+int TreeRemover::next()
+{
+    WalkEntry entry;
+    struct stat entry_stat;
+    int ret_code;
+
+    if ((ret_code = _walker.next(&entry)) <= 0) {
+        return ret_code;
+    }
+
+    switch (entry.event) {
+    case WALK_PRE_DIR:
+        // directory is removed after its content
+        return 1;
+    case WALK_POST_DIR:
+        if (entry.depth == 0) {
+            // the root directory is the last entry
+            if (!_remove_root) {
+                return 0;
+            }
+            if (remove(entry.path)) {
+                return -1;
+            }
+            _entries_removed++;
+            return 0;
+        }
+        break;
+    default:
+        if (entry.type != DT_REG && entry.type != DT_LNK) {
+            // unsupported type
+            errno = EPERM;
+            return -1;
+        }
+        if (_count_bytes) {
+            if (entry.stat == NULL) {
+                if (lstat_entry_impl(entry.dir_fd, entry.path, entry.name, &entry_stat)) {
+                    return -1;
+                }
+                entry.stat = &entry_stat;
+            }
+            _bytes_freed += entry.stat->st_size;
+        }
+        break;
+    }
+    if (remove_entry_impl(entry)) {
+        return -1;
+    }
+    _entries_removed++;
+    return 1;
+}
 
-    tmp_ret_code = closedir(dir);
-    if (tmp_ret_code && !ret_code) {
-        ret_code = tmp_ret_code;
+void TreeRemover::release_buff()
+{
+    if (_path != NULL) {
+        // entries of the tree could be cached during the removal
+        _path[_root_len] = '\0';
+        stat_cache_invalidate(_path);
+    }
+    if (_cleanup_buff) {
+        delete[] _path;
+        _cleanup_buff = false;
     }
+    _path = NULL;
+}
+
+//--------------------------------------------------------------------------------
+// rmtree/cleartree
+//--------------------------------------------------------------------------------
+
+static int rmtree_impl(const char *path, char *buff, size_t buff_len, size_t max_open_dirs, bool remove_dir)
+{
+    TreeRemover remover(max_open_dirs);
 
-    // remove directory itself
-    if (!ret_code && remove_dir) {
-        ret_code = remove(path_buff);
+    if (remover.start(path, remove_dir, false, buff, buff_len)) {
+        return -1;
     }
+    return remover.step();
+}
 
-    return ret_code;
+int pathutil::rmtree(const char *path, char *buff, size_t buff_len, size_t max_open_dirs)
+{
+    return rmtree_impl(path, buff, buff_len, max_open_dirs, true);
+}
+
+int pathutil::cleartree(const char *path, char *buff, size_t buff_len, size_t max_open_dirs)
+{
+    return rmtree_impl(path, buff, buff_len, max_open_dirs, false);
+}
+
+//--------------------------------------------------------------------------------
+// DiskUsageScanner
+//
+// The scanner processes entries of the TreeWalker like TreeRemover does, but only files require stat calls,
+// as directory types are known from the directory reading.
+//--------------------------------------------------------------------------------
+
+DiskUsageScanner::DiskUsageScanner(size_t max_open_dirs)
+    : _state(STATE_IDLE)
+    , _walker(max_open_dirs)
+    , _buff(NULL)
+    , _cleanup_buff(false)
+    , _bytes(0)
+    , _files(0)
+    , _dirs(0)
+{
+}
+
+DiskUsageScanner::~DiskUsageScanner()
+{
+    cancel();
+}
+
+int DiskUsageScanner::start(const char *path, char *buff, size_t buff_len)
+{
+    int origin_errno = errno;
+
+    if (cancel()) {
+        return -1;
+    }
+    _bytes = 0;
+    _files = 0;
+    _dirs = 0;
+
+    if (buff == NULL) {
+        buff = new char[DEFAULT_RMTREE_BUFF_SIZE];
+        buff_len = DEFAULT_RMTREE_BUFF_SIZE;
+        _cleanup_buff = true;
+    }
+    _buff = buff;
+
+    if (_walker.start(path, buff, buff_len)) {
+        release_buff();
+        _state = STATE_FAILED;
+        return -1;
+    }
+    _state = STATE_RUNNING;
+
+    errno = origin_errno;
+    return 0;
+}
+
+int DiskUsageScanner::step(size_t max_entries, uint32_t max_time_us)
+{
+    int ret_code;
+    int origin_errno = errno;
+    size_t entries = 0;
+    uint32_t start_time = 0;
+
+    if (_state != STATE_RUNNING) {
+        if (_state == STATE_DONE) {
+            return 0;
+        }
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (max_time_us) {
+        start_time = us_ticker_read();
+    }
+    while ((ret_code = next()) > 0) {
+        if (max_entries && ++entries >= max_entries) {
+            break;
+        }
+        if (max_time_us && us_ticker_read() - start_time >= max_time_us) {
+            break;
+        }
+    }
+
+    if (ret_code > 0) {
+        errno = origin_errno;
+        return 1;
+    }
+    if (_walker.cancel() && !ret_code) {
+        ret_code = -1;
+    }
+    release_buff();
+    if (ret_code) {
+        if (!errno) {
+            errno = EIO;
+        }
+        _state = STATE_FAILED;
+        return -1;
+    }
+    _state = STATE_DONE;
+    errno = origin_errno;
+    return 0;
+}
+
+int DiskUsageScanner::cancel()
+{
+    int ret_code = _walker.cancel();
+    release_buff();
+    if (_state == STATE_RUNNING) {
+        _state = STATE_IDLE;
+    }
+    return ret_code;
+}
+
+int DiskUsageScanner::next()
+{
+    WalkEntry entry;
+    struct stat entry_stat;
+    int ret_code;
+
+    if ((ret_code = _walker.next(&entry)) <= 0) {
+        return ret_code;
+    }
+
+    switch (entry.event) {
+    case WALK_PRE_DIR:
+        if (entry.depth > 0) {
+            _dirs++;
+        }
+        break;
+    case WALK_POST_DIR:
+        break;
+    default:
+        if (entry.stat == NULL) {
+            if (lstat_entry_impl(entry.dir_fd, entry.path, entry.name, &entry_stat)) {
+                return -1;
+            }
+            entry.stat = &entry_stat;
+        }
+        _bytes += entry.stat->st_size;
+        _files++;
+        break;
+    }
+    return 1;
+}
+
+void DiskUsageScanner::release_buff()
+{
+    if (_cleanup_buff) {
+        delete[] _buff;
+        _cleanup_buff = false;
+    }
+    _buff = NULL;
+}
+
+int pathutil::disk_usage(const char *path, uint64_t *bytes, size_t *files, size_t *dirs, char *buff, size_t buff_len,
+                         size_t max_open_dirs)
+{
+    DiskUsageScanner scanner(max_open_dirs);
+
+    if (scanner.start(path, buff, buff_len) || scanner.step()) {
+        return -1;
+    }
+    if (bytes != NULL) {
+        *bytes = scanner.bytes();
+    }
+    if (files != NULL) {
+        *files = scanner.files();
+    }
+    if (dirs != NULL) {
+        *dirs = scanner.dirs();
+    }
+    return 0;
+}
+
+#if PATHUTIL_USE_AT_FUNCTIONS
+/**
+ * Create directory \p path relative to its existing ancestor.
+ *
+ * @param path directory path
+ * @param base_end position of the separator after the ancestor path
+ * @param base_fd descriptor of the ancestor directory. If it's -1, the ancestor is opened and \p base_fd is updated.
+ *                If the ancestor can't be opened, it's set to -2 and \p path is created by \c mkdir.
+ * @param mode directory mode
+ * @return 0 on success, otherwise non-zero value
+ */
+static int mkdir_relative(char *path, char *base_end, int &base_fd, mode_t mode)
+{
+    char sym;
+    int origin_errno = errno;
+    if (base_fd == -1) {
+        sym = *base_end;
+        *base_end = '\0';
+        base_fd = open_base_dir_impl(path);
+        *base_end = sym;
+        if (base_fd < 0) {
+            // the ancestor can't be opened, but mkdir can still succeed, so full paths are used
+            base_fd = -2;
+            errno = origin_errno;
+        }
+    }
+    if (base_fd < 0) {
+        return mkdir(path, mode);
+    }
+    return mkdirat(base_fd, base_end + 1, mode);
+}
+#endif
+
+/**
+ * Check if \p path is a directory with a single \c stat call.
+ *
+ * The stat cache isn't used, so \c MakedirsStats::stat_calls counts real calls only.
+ */
+static bool isdir_by_stat_impl(const char *path, MakedirsStats &stats)
+{
+    struct stat path_stat;
+    int origin_errno = errno;
+    bool is_dir_flag;
+
+    stats.stat_calls++;
+    is_dir_flag = stat(path, &path_stat) == 0 && S_ISDIR(path_stat.st_mode);
+    errno = origin_errno;
+    return is_dir_flag;
+}
+
+/**
+ * Find the most deep existing directory of \p path using \c stat calls from the leaf to the root.
+ *
+ * @param buff normalized path
+ * @param buff_end end of the path
+ * @param first_existed_pos end of the existing directory path
+ * @param top_dir_flag it's set, if no directories exist, so the top level one should be skipped
+ * @param stats call counters
+ */
+static void find_existing_by_stat_impl(char *buff, char *buff_end, char *&first_existed_pos, bool &top_dir_flag, MakedirsStats &stats)
+{
+    char sym;
+    bool is_dir_flag;
+
+    first_existed_pos = buff_end;
+    while (true) {
+        sym = *first_existed_pos;
+        *first_existed_pos = '\0';
+        is_dir_flag = isdir_by_stat_impl(buff, stats);
+        *first_existed_pos = sym;
+        if (is_dir_flag) {
+            break;
+        }
+
+        do {
+            first_existed_pos--;
+        } while (first_existed_pos > buff && *first_existed_pos != SEP);
+        if (first_existed_pos == buff) {
+            top_dir_flag = true;
+            break;
+        }
+    }
+}
+
+/**
+ * Find the most deep existing directory of \p path using \c mkdir calls from the leaf to the root.
+ *
+ * The leaf directory is created at first. Parent directories are probed only if \c mkdir fails with \c ENOENT.
+ *
+ * @param buff normalized path
+ * @param buff_end end of the path
+ * @param mode directory mode
+ * @param first_existed_pos end of the existing (or just created) directory path
+ * @param top_dir_flag it's set, if no directories exist, so the top level one should be skipped
+ * @param stats call counters
+ * @return 1, if the leaf directory has been created, 0 if \p first_existed_pos has been found, -1 on error
+ */
+static int find_existing_by_mkdir_impl(char *buff, char *buff_end, mode_t mode, char *&first_existed_pos, bool &top_dir_flag, MakedirsStats &stats)
+{
+    char sym;
+    int ret_code;
+    bool is_dir_flag;
+    int origin_errno = errno;
+    char *top_end = strchr(buff + 1, SEP);
+
+    if (top_end == NULL) {
+        // top level directories cannot be created, so only check leaf existence
+        find_existing_by_stat_impl(buff, buff_end, first_existed_pos, top_dir_flag, stats);
+        return 0;
+    }
+
+    first_existed_pos = buff_end;
+    while (first_existed_pos > top_end) {
+        sym = *first_existed_pos;
+        *first_existed_pos = '\0';
+        ret_code = mkdir(buff, mode);
+        stats.mkdir_calls++;
+        *first_existed_pos = sym;
+        if (ret_code == 0) {
+            errno = origin_errno;
+            return first_existed_pos == buff_end ? 1 : 0;
+        }
+        if (errno == EEXIST) {
+            if (first_existed_pos == buff_end) {
+                // check that leaf is directory, not a file
+                is_dir_flag = isdir_by_stat_impl(buff, stats);
+                if (!is_dir_flag) {
+                    errno = EEXIST;
+                    return -1;
+                }
+            }
+            errno = origin_errno;
+            return 0;
+        }
+        if (errno != ENOENT) {
+            return -1;
+        }
+        do {
+            first_existed_pos--;
+        } while (*first_existed_pos != SEP);
+    }
+    // top level directory is expected to be mount point
+    errno = origin_errno;
+    return 0;
+}
+
+int pathutil::makedirs(const char *path, mode_t mode, bool exists_ok, char *buff, size_t buff_len,
+                       MakedirsStrategy strategy, MakedirsStats *stats)
+{
+    bool cleanup_buff = false;
+    int ret_code = 0;
+    char *pos;
+    char *first_existed_pos;
+    char *buff_end;
+    char sym;
+    // note due mbed-os implementation, we cannot explicitly create directories in the root "/",
+    // so we should ignore them
+    bool top_dir_flag = false;
+    size_t path_len = strlen(path);
+    MakedirsStats call_stats = {0, 0};
+#if PATHUTIL_USE_AT_FUNCTIONS
+    // the most deep existing directory, that is used as base for relative mkdirat calls
+    int base_fd = -1;
+    char *base_end = NULL;
+#endif
+
+    if (stats != NULL) {
+        *stats = call_stats;
+    }
+
+    if (!isabs(path)) {
+        // relative paths aren't supported
+        errno = ENOENT;
+        return -1;
+    }
+
+    if (buff == NULL) {
+        buff = new char[path_len + 1];
+        cleanup_buff = true;
+    } else if (path_len + 1 > buff_len) {
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    // copy and normalize path
+    strcpy(buff, path);
+    normpath(buff);
+    path_len = strlen(buff);
+    buff_end = buff + path_len;
+
+    // determine which directory aren't exists
+    if (strategy == MAKEDIRS_MKDIR_FIRST) {
+        ret_code = find_existing_by_mkdir_impl(buff, buff_end, mode, first_existed_pos, top_dir_flag, call_stats);
+    } else {
+        find_existing_by_stat_impl(buff, buff_end, first_existed_pos, top_dir_flag, call_stats);
+    }
+
+    if (ret_code) {
+        // leaf directory has been created or error has been occurred
+        ret_code = ret_code > 0 ? 0 : -1;
+    } else if (first_existed_pos == buff_end) {
+        // given directory exists
+        if (!exists_ok) {
+            errno = EEXIST;
+            ret_code = -1;
+        }
+    } else {
+        // create directories
+        pos = first_existed_pos + 1;
+#if PATHUTIL_USE_AT_FUNCTIONS
+        base_end = first_existed_pos;
+#endif
+        while (pos <= buff_end) {
+            sym = *pos;
+            if (sym == SEP || sym == '\0') {
+                *pos = '\0';
+                if (!top_dir_flag) {
+#if PATHUTIL_USE_AT_FUNCTIONS
+                    ret_code = mkdir_relative(buff, base_end, base_fd, mode);
+#else
+                    ret_code = mkdir(buff, mode);
+#endif
+                    call_stats.mkdir_calls++;
+                } else {
+                    ret_code = 0;
+                    top_dir_flag = false;
+#if PATHUTIL_USE_AT_FUNCTIONS
+                    base_end = pos;
+#endif
+                }
+                *pos = sym;
+                if (ret_code) {
+                    break;
+                }
+            }
+            pos++;
+        }
+    }
+
+#if PATHUTIL_USE_AT_FUNCTIONS
+    if (base_fd >= 0 && close(base_fd) && !ret_code) {
+        ret_code = -1;
+    }
+#endif
+    if (call_stats.mkdir_calls) {
+        stat_cache_invalidate(buff);
+    }
+    if (cleanup_buff) {
+        delete[] buff;
+    }
+    if (stats != NULL) {
+        *stats = call_stats;
+    }
+    return ret_code;
+}
+
+/**
+ * Item of the \c makedirs_batch and \c stat_batch work lists.
+ */
+struct BatchEntry {
+    // normalized path
+    char *path;
+    // position of the path in the original list
+    size_t index;
+    // position of the base name in the normalized path
+    size_t name_pos;
+};
+
+static size_t batch_entries_size_impl(size_t n)
+{
+    // align names after entries to keep arbitrary buffer usable
+    return n * sizeof(BatchEntry) + sizeof(BatchEntry);
+}
+
+static size_t batch_buff_size_impl(const char *const *paths, size_t n)
+{
+    size_t buff_size = batch_entries_size_impl(n);
+    for (size_t i = 0; i < n; i++) {
+        buff_size += strlen(paths[i]) + 1;
+    }
+    return buff_size;
+}
+
+/**
+ * Copy normalized paths to buffer and create work list.
+ *
+ * @param paths
+ * @param n - number of paths
+ * @param buff - buffer with at least \c batch_buff_size_impl bytes
+ * @return work list
+ */
+static BatchEntry *batch_prepare_impl(const char *const *paths, size_t n, char *buff)
+{
+    BatchEntry *entries = (BatchEntry *)(buff + (-(uintptr_t)buff & (sizeof(void *) - 1)));
+    char *names = buff + batch_entries_size_impl(n);
+    char *name;
+
+    for (size_t i = 0; i < n; i++) {
+        entries[i].path = names;
+        entries[i].index = i;
+        strcpy(names, paths[i]);
+        normpath(names);
+        name = strrchr(names, SEP);
+        entries[i].name_pos = name == NULL ? 0 : name - names + 1;
+        names += strlen(names) + 1;
+    }
+    return entries;
+}
+
+/**
+ * Compare paths so, that separator goes before any other symbol.
+ *
+ * It guarantees that directory is followed by its subdirectories, so common prefixes are adjacent.
+ */
+static int makedirs_batch_compare_impl(const void *a, const void *b)
+{
+    const unsigned char *p1 = (const unsigned char *)((const BatchEntry *)a)->path;
+    const unsigned char *p2 = (const unsigned char *)((const BatchEntry *)b)->path;
+    int c1, c2;
+
+    while (*p1 != '\0' && *p1 == *p2) {
+        p1++;
+        p2++;
+    }
+    c1 = *p1 == SEP ? 1 : *p1 == '\0' ? 0 : *p1 + 1;
+    c2 = *p2 == SEP ? 1 : *p2 == '\0' ? 0 : *p2 + 1;
+    return c1 - c2;
+}
+
+/**
+ * Find length of the common directory prefix of the \p path and the existing directory \p known.
+ */
+static size_t makedirs_batch_common_impl(const char *known, size_t known_len, const char *path)
+{
+    size_t i = 0;
+    size_t common = 0;
+
+    while (i < known_len && known[i] == path[i]) {
+        i++;
+        if ((i == known_len || known[i] == SEP) && (path[i] == SEP || path[i] == '\0')) {
+            common = i;
+        }
+    }
+    return common;
+}
+
+size_t pathutil::makedirs_batch_buff_size(const char *const *paths, size_t n)
+{
+    return batch_buff_size_impl(paths, n);
+}
+
+int pathutil::makedirs_batch(const char *const *paths, size_t n, mode_t mode, int *errors,
+                             char *buff, size_t buff_len, MakedirsStats *stats)
+{
+    bool cleanup_buff = false;
+    int origin_errno = errno;
+    int first_error = 0;
+    size_t first_error_index = n;
+    size_t required_len = batch_buff_size_impl(paths, n);
+    MakedirsStats call_stats = {0, 0};
+    BatchEntry *entries;
+    const char *known = "";
+    size_t known_len = 0;
+
+    if (stats != NULL) {
+        *stats = call_stats;
+    }
+
+    if (buff == NULL) {
+        buff = new char[required_len];
+        cleanup_buff = true;
+    } else if (required_len > buff_len) {
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    // prepare normalized paths
+    entries = batch_prepare_impl(paths, n, buff);
+    qsort(entries, n, sizeof(BatchEntry), makedirs_batch_compare_impl);
+
+    for (size_t i = 0; i < n; i++) {
+        char *path = entries[i].path;
+        char *top_end;
+        char *pos;
+        char sym;
+        int error = 0;
+        size_t mkdir_calls = call_stats.mkdir_calls;
+
+        if (!isabs(path)) {
+            // relative paths aren't supported
+            error = ENOENT;
+        } else {
+            // skip directories, that have been checked for the previous path
+            pos = path + makedirs_batch_common_impl(known, known_len, path);
+            top_end = strchr(path + 1, SEP);
+            known = path;
+            known_len = pos - path;
+            if (*pos != '\0' && top_end != NULL) {
+                // most of directories usually exist, so check the leaf before creation of the missing parents
+                if (isdir_by_stat_impl(path, call_stats)) {
+                    pos += strlen(pos);
+                    known_len = pos - path;
+                }
+            }
+            while (*pos != '\0' && !error) {
+                do {
+                    pos++;
+                } while (*pos != SEP && *pos != '\0');
+                if (top_end != NULL && pos > top_end) {
+                    sym = *pos;
+                    *pos = '\0';
+                    if (mkdir(path, mode)) {
+                        error = errno;
+                    }
+                    call_stats.mkdir_calls++;
+                    if (error == EEXIST) {
+                        error = 0;
+                        if (sym == '\0') {
+                            // check that leaf is directory, not a file
+                            if (!isdir_by_stat_impl(path, call_stats)) {
+                                error = EEXIST;
+                            }
+                        }
+                    }
+                    *pos = sym;
+                }
+                // note: top level directories are mount points, so they cannot be created explicitly
+                if (!error) {
+                    known_len = pos - path;
+                }
+            }
+        }
+
+        if (call_stats.mkdir_calls != mkdir_calls) {
+            stat_cache_invalidate(path);
+        }
+        if (errors != NULL) {
+            errors[entries[i].index] = error;
+        }
+        if (error && entries[i].index < first_error_index) {
+            first_error_index = entries[i].index;
+            first_error = error;
+        }
+    }
+
+    if (cleanup_buff) {
+        delete[] buff;
+    }
+    if (stats != NULL) {
+        *stats = call_stats;
+    }
+    if (first_error) {
+        errno = first_error;
+        return -1;
+    }
+    errno = origin_errno;
+    return 0;
+}
+
+static void fill_path_info_impl(const struct stat *path_stat, PathInfo *info)
+{
+    switch (path_stat->st_mode & S_IFMT) {
+    case S_IFREG:
+        info->type = PATH_TYPE_FILE;
+        break;
+    case S_IFDIR:
+        info->type = PATH_TYPE_DIR;
+        break;
+    default:
+        info->type = PATH_TYPE_OTHER;
+        break;
+    }
+    info->size = path_stat->st_size;
+    info->mtime = path_stat->st_mtime;
+    info->error = 0;
+}
+
+static void fill_path_error_impl(int error, PathInfo *info)
+{
+    info->type = PATH_TYPE_NONE;
+    info->size = 0;
+    info->mtime = 0;
+    info->error = error ? error : EIO;
+}
+
+int pathutil::path_info(const char *path, PathInfo *info)
+{
+    struct stat path_stat;
+    int origin_errno = errno;
+
+    if (stat_cached(path, &path_stat)) {
+        fill_path_error_impl(errno, info);
+        errno = origin_errno;
+        return -1;
+    }
+    fill_path_info_impl(&path_stat, info);
+    return 0;
+}
+
+size_t pathutil::path_info_batch(const char *const *paths, size_t n, PathInfo *infos)
+{
+    size_t exists_num = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (path_info(paths[i], &infos[i]) == 0) {
+            exists_num++;
+        }
+    }
+    return exists_num;
+}
+
+/**
+ * Compare paths by parent directory and then by name, so entries of the same directory are adjacent.
+ */
+static int stat_batch_compare_impl(const void *a, const void *b)
+{
+    const BatchEntry *e1 = (const BatchEntry *)a;
+    const BatchEntry *e2 = (const BatchEntry *)b;
+    int ret_code;
+
+    if (e1->name_pos != e2->name_pos) {
+        ret_code = memcmp(e1->path, e2->path, e1->name_pos < e2->name_pos ? e1->name_pos : e2->name_pos);
+        if (ret_code == 0) {
+            ret_code = e1->name_pos < e2->name_pos ? -1 : 1;
+        }
+        return ret_code;
+    }
+    ret_code = memcmp(e1->path, e2->path, e1->name_pos);
+    if (ret_code == 0) {
+        ret_code = strcmp(e1->path + e1->name_pos, e2->path + e2->name_pos);
+    }
+    return ret_code;
+}
+
+static bool stat_batch_same_dir_impl(const BatchEntry *e1, const BatchEntry *e2)
+{
+    return e1->name_pos == e2->name_pos && memcmp(e1->path, e2->path, e1->name_pos) == 0;
+}
+
+/**
+ * Temporary truncate entry path to its parent directory.
+ *
+ * @return replaced symbol, that should be restored
+ */
+static char stat_batch_dir_begin_impl(BatchEntry *entry, char *&dir_end)
+{
+    char sym;
+    // root directory keeps its separator
+    dir_end = entry->path + (entry->name_pos > 1 ? entry->name_pos - 1 : entry->name_pos);
+    sym = *dir_end;
+    *dir_end = '\0';
+    return sym;
+}
+
+static void stat_batch_path_impl(BatchEntry *entry, PathInfo *results)
+{
+    struct stat path_stat;
+    if (stat(entry->path, &path_stat)) {
+        fill_path_error_impl(errno, &results[entry->index]);
+    } else {
+        fill_path_info_impl(&path_stat, &results[entry->index]);
+    }
+}
+
+#if PATHUTIL_USE_AT_FUNCTIONS
+/**
+ * Get information about entries of the same directory relative to it.
+ */
+static void stat_batch_at_impl(BatchEntry *group, size_t group_len, PathInfo *results)
+{
+    struct stat path_stat;
+    char *dir_end;
+    char sym = stat_batch_dir_begin_impl(group, dir_end);
+    int dir_fd = open_base_dir_impl(group->path);
+    int dir_error = errno;
+    *dir_end = sym;
+
+    if (dir_fd < 0 && dir_error != ENOENT && dir_error != ENOTDIR) {
+        // entries can be accessible even if the directory can't be opened, so use separate calls
+        for (size_t i = 0; i < group_len; i++) {
+            stat_batch_path_impl(&group[i], results);
+        }
+        return;
+    }
+    for (size_t i = 0; i < group_len; i++) {
+        PathInfo *info = &results[group[i].index];
+        if (dir_fd < 0) {
+            fill_path_error_impl(dir_error, info);
+        } else if (fstatat(dir_fd, group[i].path + group[i].name_pos, &path_stat, 0)) {
+            fill_path_error_impl(errno, info);
+        } else {
+            fill_path_info_impl(&path_stat, info);
+        }
+    }
+    if (dir_fd >= 0) {
+        close(dir_fd);
+    }
+}
+#else
+/**
+ * Get types of entries of the same directory by single directory reading.
+ */
+static void stat_batch_readdir_impl(BatchEntry *group, size_t group_len, PathInfo *results)
+{
+    struct dirent *dir_entity;
+    char *dir_end;
+    char sym = stat_batch_dir_begin_impl(group, dir_end);
+    DIR *dir = opendir(group->path);
+    int error = errno;
+    size_t low, high, mid;
+    *dir_end = sym;
+
+    if (dir == NULL && error != ENOENT && error != ENOTDIR) {
+        // directory without read permission can't be read, but its entries can be accessible
+        for (size_t i = 0; i < group_len; i++) {
+            stat_batch_path_impl(&group[i], results);
+        }
+        return;
+    }
+    for (size_t i = 0; i < group_len; i++) {
+        fill_path_error_impl(dir == NULL ? error : ENOENT, &results[group[i].index]);
+    }
+    if (dir == NULL) {
+        return;
+    }
+
+    errno = 0;
+    while ((dir_entity = readdir_child(dir)) != NULL) {
+        // find the first entry with the same name
+        low = 0;
+        high = group_len;
+        while (low < high) {
+            mid = (low + high) / 2;
+            if (strcmp(group[mid].path + group[mid].name_pos, dir_entity->d_name) < 0) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        for (; low < group_len && strcmp(group[low].path + group[low].name_pos, dir_entity->d_name) == 0; low++) {
+            PathInfo *info = &results[group[low].index];
+            info->error = 0;
+            switch (dir_entity->d_type) {
+            case DT_REG:
+                info->type = PATH_TYPE_FILE;
+                break;
+            case DT_DIR:
+                info->type = PATH_TYPE_DIR;
+                break;
+            case DT_UNKNOWN:
+                stat_batch_path_impl(&group[low], results);
+                break;
+            default:
+                info->type = PATH_TYPE_OTHER;
+                break;
+            }
+        }
+        errno = 0;
+    }
+    error = errno;
+    closedir(dir);
+
+    if (error) {
+        // fallback to separate calls
+        for (size_t i = 0; i < group_len; i++) {
+            stat_batch_path_impl(&group[i], results);
+        }
+    }
 }
+#endif
 
-#define DEFAULT_RMTREE_BUFF_SIZE 256
-
-static int rmtree_impl(const char *path, char *buff, size_t buff_len, bool remove_dir = true)
+ssize_t pathutil::stat_batch(const char *const *paths, size_t n, PathInfo *results, bool type_only,
+                             char *buff, size_t buff_len)
 {
     bool cleanup_buff = false;
-    int ret_code = 0;
-
-    size_t path_len = strlen(path);
+    int origin_errno = errno;
+    size_t required_len = batch_buff_size_impl(paths, n);
+    size_t group_start;
+    size_t group_end;
+    ssize_t exists_num = 0;
+    BatchEntry *entries;
 
     if (buff == NULL) {
-        // check that buffer can store current path
-        if (path_len + 1 > DEFAULT_RMTREE_BUFF_SIZE) {
-            errno = ENOBUFS;
-            return -1;
+        buff = new char[required_len];
+        cleanup_buff = true;
+    } else if (required_len > buff_len) {
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    entries = batch_prepare_impl(paths, n, buff);
+    qsort(entries, n, sizeof(BatchEntry), stat_batch_compare_impl);
+
+    for (group_start = 0; group_start < n; group_start = group_end) {
+        BatchEntry *group = entries + group_start;
+        group_end = group_start + 1;
+        while (group_end < n && stat_batch_same_dir_impl(group, &entries[group_end])) {
+            group_end++;
         }
-        buff = new char[DEFAULT_RMTREE_BUFF_SIZE];
-        buff_len = DEFAULT_RMTREE_BUFF_SIZE;
-    } else {
-        // check that buffer can store current path
-        if (path_len + 1 > buff_len) {
-            errno = ENOBUFS;
-            return -1;
+
+        if (group->name_pos == 0 || group->path[group->name_pos] == '\0') {
+            // path without parent directory or root directory
+            for (size_t i = group_start; i < group_end; i++) {
+                stat_batch_path_impl(&entries[i], results);
+            }
+            continue;
+        }
+#if PATHUTIL_USE_AT_FUNCTIONS
+        (void)type_only;
+        stat_batch_at_impl(group, group_end - group_start, results);
+#else
+        if (type_only && group_end - group_start > 1) {
+            stat_batch_readdir_impl(group, group_end - group_start, results);
+        } else {
+            for (size_t i = group_start; i < group_end; i++) {
+                stat_batch_path_impl(&entries[i], results);
+            }
         }
+#endif
     }
-    strcpy(buff, path);
-
-    ret_code = rmtree_recursive_impl(buff, path_len, buff_len, remove_dir);
 
+    for (size_t i = 0; i < n; i++) {
+        if (results[i].error == 0) {
+            exists_num++;
+        }
+    }
     if (cleanup_buff) {
         delete[] buff;
     }
-    return ret_code;
+    errno = origin_errno;
+    return exists_num;
 }
 
-int pathutil::rmtree(const char *path, char *buff, size_t buff_len)
+//--------------------------------------------------------------------------------
+// DirListing
+//
+// Entries are allocated in the arena one after another while the directory is read, so no index is required
+// during reading. After that the array of entry pointers is allocated and filled by walking over the records.
+//
+// If PATHUTIL_USE_AT_FUNCTIONS is enabled, the directory is kept opened and entry information is got relative
+// to it (fstatat). Otherwise the directory is closed after reading and its path is stored in the arena
+// with space for the longest entry name, so the full entry path is built without extra buffers.
+//--------------------------------------------------------------------------------
+
+/**
+ * Get the next record of the entries, that are packed in the arena.
+ */
+static DirEntry *next_dir_entry_impl(DirEntry *entry)
 {
-    return rmtree_impl(path, buff, buff_len, true);
+    uintptr_t end = (uintptr_t)(entry + 1) + entry->name_len + 1;
+    return (DirEntry *)((end + alignof(DirEntry) - 1) & ~(uintptr_t)(alignof(DirEntry) - 1));
 }
 
-int pathutil::cleartree(const char *path, char *buff, size_t buff_len)
+static int dir_entry_compare_name_impl(const void *a, const void *b)
 {
-    return rmtree_impl(path, buff, buff_len, false);
+    return strcmp((*(const DirEntry * const *)a)->name(), (*(const DirEntry * const *)b)->name());
 }
 
-int pathutil::makedirs(const char *path, mode_t mode, bool exists_ok, char *buff, size_t buff_len)
+static int dir_entry_compare_dirs_first_impl(const void *a, const void *b)
 {
-    bool cleanup_buff = false;
-    int ret_code = 0;
-    char *pos;
-    char *first_existed_pos;
-    char *buff_end;
-    char sym;
-    bool is_dir_flag;
-    // note due mbed-os implementation, we cannot explicitly create directories in the root "/",
-    // so we should ignore them
-    bool top_dir_flag = false;
-    size_t path_len = strlen(path);
-
-    if (!isabs(path)) {
-        // relative paths aren't supported
-        errno = ENOENT;
-        return -1;
+    bool a_dir = (*(const DirEntry * const *)a)->type == DT_DIR;
+    bool b_dir = (*(const DirEntry * const *)b)->type == DT_DIR;
+    if (a_dir != b_dir) {
+        return a_dir ? -1 : 1;
     }
+    return dir_entry_compare_name_impl(a, b);
+}
 
-    if (buff == NULL) {
-        buff = new char[path_len + 1];
-        cleanup_buff = true;
-    } else if (path_len + 1 > buff_len) {
-        errno = ENOBUFS;
+DirListing::DirListing()
+    : _dir(NULL)
+    , _path(NULL)
+    , _path_len(0)
+    , _opened(false)
+    , _entries(NULL)
+    , _size(0)
+{
+}
+
+DirListing::~DirListing()
+{
+    close();
+}
+
+int DirListing::scan(const char *path, PathArena &arena, DirSortOrder order, const GlobPattern *pattern)
+{
+    struct dirent *dir_ent;
+    DirEntry *first_entry = NULL;
+    DirEntry *entry;
+    size_t name_len;
+    size_t max_name_len = 0;
+    size_t count = 0;
+    int origin_errno = errno;
+    int error;
+
+    close();
+    _entries = NULL;
+    _size = 0;
+    _dir = opendir(path);
+    if (_dir == NULL) {
         return -1;
     }
 
-    // copy and normalize path
-    strcpy(buff, path);
-    normpath(buff);
-    path_len = strlen(buff);
-    buff_end = buff + path_len;
-
-    // determine which directory aren't exists
-    first_existed_pos = buff_end;
-    while (true) {
-        sym = *first_existed_pos;
-        *first_existed_pos = '\0';
-        is_dir_flag = isdir(buff);
-        *first_existed_pos = sym;
-        if (is_dir_flag) {
-            break;
+    errno = 0;
+    while ((dir_ent = pattern != NULL ? readdir_match(_dir, *pattern) : readdir_child(_dir)) != NULL) {
+        name_len = strlen(dir_ent->d_name);
+        entry = (DirEntry *)arena.allocate(sizeof(DirEntry) + name_len + 1, alignof(DirEntry));
+        if (entry == NULL) {
+            goto error;
         }
-
-        do {
-            first_existed_pos--;
-        } while (first_existed_pos > buff && *first_existed_pos != SEP);
-        if (first_existed_pos == buff) {
-            top_dir_flag = true;
-            break;
+        if (first_entry == NULL) {
+            first_entry = entry;
         }
+        entry->name_len = (uint16_t)name_len;
+        entry->type = dir_ent->d_type;
+        entry->info_flag = false;
+        memcpy((char *)entry->name(), dir_ent->d_name, name_len + 1);
+        if (name_len > max_name_len) {
+            max_name_len = name_len;
+        }
+        count++;
+    }
+    if (errno) {
+        goto error;
     }
 
-    if (first_existed_pos == buff_end) {
-        // given directory exists
-        if (!exists_ok) {
-            errno = EEXIST;
-            ret_code = -1;
-        }
-    } else {
-        // create directories
-        pos = first_existed_pos + 1;
-        while (pos <= buff_end) {
-            sym = *pos;
-            if (sym == SEP || sym == '\0') {
-                *pos = '\0';
-                if (!top_dir_flag) {
-                    ret_code = mkdir(buff, mode);
-                } else {
-                    ret_code = 0;
-                    top_dir_flag = false;
-                }
-                *pos = sym;
-                if (ret_code) {
-                    break;
+    _entries = (DirEntry **)arena.allocate(sizeof(DirEntry *) * count, alignof(DirEntry *));
+    if (_entries == NULL) {
+        goto error;
+    }
+    entry = first_entry;
+    for (size_t i = 0; i < count; i++) {
+        _entries[i] = entry;
+        entry = next_dir_entry_impl(entry);
+    }
+#if !PATHUTIL_USE_AT_FUNCTIONS
+    _path_len = strlen(path);
+    _path = (char *)arena.allocate(_path_len + max_name_len + 2, 1);
+    if (_path == NULL) {
+        goto error;
+    }
+    memcpy(_path, path, _path_len + 1);
+    closedir(_dir);
+    _dir = NULL;
+#endif
+    _opened = true;
+    _size = count;
+
+    if (order != DIR_SORT_NONE) {
+        if (order == DIR_SORT_DIRS_FIRST) {
+            // file system doesn't provide entry types, so they should be got by stat
+            for (size_t i = 0; i < count; i++) {
+                if (_entries[i]->type == DT_UNKNOWN) {
+                    info(i);
                 }
             }
-            pos++;
         }
+        qsort(_entries, count, sizeof(DirEntry *),
+              order == DIR_SORT_NAME ? dir_entry_compare_name_impl : dir_entry_compare_dirs_first_impl);
     }
+    errno = origin_errno;
+    return 0;
 
-    if (cleanup_buff) {
-        delete[] buff;
+error:
+    error = errno;
+    close();
+    _entries = NULL;
+    _size = 0;
+    errno = error;
+    return -1;
+}
+
+int DirListing::close()
+{
+    int ret_code = 0;
+
+    if (_dir != NULL) {
+        ret_code = closedir(_dir);
+        _dir = NULL;
     }
+    _path = NULL;
+    _path_len = 0;
+    _opened = false;
     return ret_code;
 }
 
-bool pathutil::isdir(const char *path)
+const PathInfo &DirListing::info(size_t i)
 {
-    struct stat path_stat;
-    if (stat(path, &path_stat)) {
-        errno = 0;
-        return false;
+    DirEntry *entry = _entries[i];
+    struct stat entry_stat;
+    int origin_errno = errno;
+    int ret_code;
+
+    if (entry->info_flag) {
+        return entry->info;
+    }
+    if (!_opened) {
+        // information isn't cached, so it can't be got after the directory releasing
+        fill_path_error_impl(EBADF, &entry->info);
+        return entry->info;
+    }
+#if PATHUTIL_USE_AT_FUNCTIONS
+    ret_code = fstatat(dirfd(_dir), entry->name(), &entry_stat, 0);
+#else
+    _path[_path_len] = SEP;
+    memcpy(_path + _path_len + 1, entry->name(), entry->name_len + 1);
+    ret_code = stat(_path, &entry_stat);
+    _path[_path_len] = '\0';
+#endif
+    if (ret_code) {
+        fill_path_error_impl(errno, &entry->info);
     } else {
-        return (path_stat.st_mode & S_IFMT) == S_IFDIR;
+        fill_path_info_impl(&entry_stat, &entry->info);
+        if (entry->type == DT_UNKNOWN) {
+            entry->type = mode_to_type_impl(entry_stat.st_mode);
+        }
     }
+    entry->info_flag = true;
+    errno = origin_errno;
+    return entry->info;
 }
 
-bool pathutil::isfile(const char *path)
+bool pathutil::isabs(const char *path)
 {
-    struct stat path_stat;
-    if (stat(path, &path_stat)) {
-        errno = 0;
+    if (path[0] == '\0') {
         return false;
     } else {
-        return (path_stat.st_mode & S_IFMT) == S_IFREG;
+        return path[0] == SEP;
     }
 }
 
-bool pathutil::exists(const char *path)
+int PathView::copy(char *buff, size_t n) const
 {
-    struct stat path_stat;
-    if (stat(path, &path_stat)) {
-        errno = 0;
-        return false;
-    } else {
-        return true;
+    if (_len + 1 > n) {
+        errno = ENOBUFS;
+        return -1;
     }
+    memmove(buff, _data, _len);
+    buff[_len] = '\0';
+    return 0;
 }
 
-ssize_t pathutil::getsize(const char *path)
+PathView PathView::parent() const
 {
-    struct stat path_stat;
-    if (stat(path, &path_stat)) {
+    size_t pos = _len;
+
+    while (pos > 0 && _data[pos - 1] != SEP) {
+        pos--;
+    }
+    if (pos == 0) {
+        // no parent directory
+        return PathView(_data, 0);
+    }
+    // remove multiple separators, but keep root one
+    pos--;
+    while (pos > 0 && _data[pos - 1] == SEP) {
+        pos--;
+    }
+    return PathView(_data, pos == 0 ? 1 : pos);
+}
+
+PathView PathView::filename() const
+{
+    size_t pos = _len;
+    while (pos > 0 && _data[pos - 1] != SEP) {
+        pos--;
+    }
+    return PathView(_data + pos, _len - pos);
+}
+
+/**
+ * Find position of the extension dot in the file name or return name length, if there is no extension.
+ */
+static size_t find_extension_impl(const PathView &name)
+{
+    size_t start = 0;
+    size_t pos = name.size();
+
+    // leading dots aren't extension separators
+    while (start < name.size() && name.data()[start] == '.') {
+        start++;
+    }
+    while (pos > start && name.data()[pos - 1] != '.') {
+        pos--;
+    }
+    return pos > start ? pos - 1 : name.size();
+}
+
+PathView PathView::stem() const
+{
+    PathView name = filename();
+    return PathView(name.data(), find_extension_impl(name));
+}
+
+PathView PathView::extension() const
+{
+    PathView name = filename();
+    size_t pos = find_extension_impl(name);
+    return PathView(name.data() + pos, name.size() - pos);
+}
+
+int PathBufferBase::assign(const char *path)
+{
+    // find path end and check its length at once
+    const char *path_end = (const char *)memchr(path, '\0', _capacity);
+    if (path_end == NULL) {
+        errno = ENOBUFS;
         return -1;
-    } else {
-        return path_stat.st_size;
     }
+    _len = path_end - path;
+    memmove(_buff, path, _len + 1);
+    return 0;
 }
 
-bool pathutil::isabs(const char *path)
+int PathBufferBase::append(const char *path_r)
 {
-    if (path[0] == '\0') {
-        return false;
-    } else {
-        return path[0] == SEP;
+    const char *path_r_end;
+    size_t pos = _len;
+
+    if (isabs(path_r) || _len == 0) {
+        return assign(path_r);
+    }
+    if (_buff[pos - 1] != SEP) {
+        pos++;
+    }
+    if (pos + 1 > _capacity || (path_r_end = (const char *)memchr(path_r, '\0', _capacity - pos)) == NULL) {
+        errno = ENOBUFS;
+        return -1;
     }
+    _buff[pos - 1] = SEP;
+    memcpy(_buff + pos, path_r, path_r_end - path_r + 1);
+    _len = pos + (path_r_end - path_r);
+    return 0;
+}
+
+int PathBufferBase::normalize()
+{
+    normpath(_buff);
+    _len = strlen(_buff);
+    return 0;
+}
+
+int PathBufferBase::dirname()
+{
+    truncate(PathView(_buff, _len).parent().size());
+    return 0;
+}
+
+const char *PathBufferBase::basename() const
+{
+    return PathView(_buff, _len).filename().data();
 }
 
 int pathutil::join_paths(char *output_path, size_t n, const char *path_l, const char *path_r)
 {
-    size_t part_l_len = strlen(path_l);
-    size_t part_r_len = strlen(path_r);
-    size_t out_len;
-    int ret_code = 0;
+    PathBufferBase path(output_path, n);
+    const char *path_l_end;
+    size_t pos;
 
-    if (isabs(path_r) || *path_l == '\0') {
-        if (part_r_len + 1 > n) {
-            ret_code = -1;
-            errno = ENOBUFS;
-        } else {
-            join_paths(output_path, path_l, path_r);
-        }
-    } else {
-        out_len = part_l_len + part_r_len;
-        if (path_l[part_l_len - 1] != SEP) {
-            out_len += 1;
-        }
-        if (out_len + 1 > n) {
-            ret_code = -1;
-            errno = ENOBUFS;
-        } else {
-            join_paths(output_path, path_l, path_r);
-        }
+    if (n == 0) {
+        errno = ENOBUFS;
+        return -1;
     }
-
-    return ret_code;
+    if (isabs(path_r)) {
+        return path.assign(path_r);
+    }
+    // check that both parts fit the buffer before writing, so it's kept unchanged on failure
+    if ((path_l_end = (const char *)memchr(path_l, '\0', n)) == NULL) {
+        errno = ENOBUFS;
+        return -1;
+    }
+    pos = path_l_end - path_l;
+    if (pos > 0 && path_l[pos - 1] != SEP) {
+        pos++;
+    }
+    if (pos + 1 > n || memchr(path_r, '\0', n - pos) == NULL) {
+        errno = ENOBUFS;
+        return -1;
+    }
+    path.assign(path_l);
+    return path.append(path_r);
 }
 
 int pathutil::join_paths(char *output_path, const char *path_l, const char *path_r)
@@ -316,56 +2000,183 @@ int pathutil::join_paths(char *output_path, const char *path_l, const char *path
 }
 
 int pathutil::append_path(char *path, size_t n, const char *path_r)
+{
+    PathBufferBase path_buff(path, n, strlen(path));
+    return path_buff.append(path_r);
+}
+
+int pathutil::append_path(char *path, const char *path_r)
 {
     int ret_code = 0;
-    size_t path_r_len = strlen(path_r);
-    size_t path_len;
+    char *pos;
 
     if (isabs(path_r) || path[0] == '\0') {
-        if (path_r_len + 1 > n) {
-            ret_code = -1;
-            errno = ENOBUFS;
-        } else {
-            append_path(path, path_r);
-        }
+        strcpy(path, path_r);
     } else {
-        path_len = strlen(path);
-        if (path[path_len - 1] != SEP) {
-            path_len += 1;
+        pos = path + strlen(path);
+        if (pos[-1] != SEP) {
+            pos[0] = SEP;
+            pos++;
         }
-        path_len += path_r_len;
-        if (path_len + 1 > n) {
-            ret_code = -1;
-            errno = ENOBUFS;
+        strcpy(pos, path_r);
+    }
+
+    return ret_code;
+}
+
+/**
+ * Check that the path is normalized component by component.
+ */
+static bool is_normalized_slow_impl(const char *path, size_t len)
+{
+    const char *end = path + len;
+    const char *pos = path;
+    const char *part_end;
+    size_t part_len;
+    // leading ".." parts of the relative path cannot be collapsed
+    bool parent_allowed = true;
+
+    if (end[-1] == SEP) {
+        // trailing separator
+        return false;
+    }
+    if (*pos == SEP) {
+        parent_allowed = false;
+        pos++;
+    }
+    while (pos < end) {
+        part_end = (const char *)memchr(pos, SEP, end - pos);
+        if (part_end == NULL) {
+            part_end = end;
+        }
+        part_len = part_end - pos;
+        if (part_len == 0 || (part_len == 1 && pos[0] == '.')) {
+            // "//" or "/./"
+            return false;
+        } else if (part_len == 2 && pos[0] == '.' && pos[1] == '.') {
+            if (!parent_allowed) {
+                return false;
+            }
         } else {
-            append_path(path, path_r);
+            parent_allowed = false;
+        }
+        pos = part_end + 1;
+    }
+    return true;
+}
+
+/**
+ * Find separator, that is followed by other separator or dot.
+ *
+ * Only such places and leading/trailing symbols of the path can contain non-normalized parts,
+ * so the search is vectorized to check the most of the paths quickly.
+ *
+ * @param path
+ * @param len - path length
+ * @return true, if separator has been found
+ */
+static bool has_sep_sequence_impl(const char *path, size_t len)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i sep_mask_32 = _mm256_set1_epi8(SEP);
+    const __m256i dot_mask_32 = _mm256_set1_epi8('.');
+    for (; i + 32 < len; i += 32) {
+        __m256i cur = _mm256_loadu_si256((const __m256i *)(path + i));
+        __m256i next = _mm256_loadu_si256((const __m256i *)(path + i + 1));
+        __m256i match = _mm256_and_si256(_mm256_cmpeq_epi8(cur, sep_mask_32),
+                                         _mm256_or_si256(_mm256_cmpeq_epi8(next, sep_mask_32), _mm256_cmpeq_epi8(next, dot_mask_32)));
+        if (_mm256_movemask_epi8(match)) {
+            return true;
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i sep_mask = _mm_set1_epi8(SEP);
+    const __m128i dot_mask = _mm_set1_epi8('.');
+    for (; i + 16 < len; i += 16) {
+        __m128i cur = _mm_loadu_si128((const __m128i *)(path + i));
+        __m128i next = _mm_loadu_si128((const __m128i *)(path + i + 1));
+        __m128i match = _mm_and_si128(_mm_cmpeq_epi8(cur, sep_mask),
+                                      _mm_or_si128(_mm_cmpeq_epi8(next, sep_mask), _mm_cmpeq_epi8(next, dot_mask)));
+        if (_mm_movemask_epi8(match)) {
+            return true;
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x16_t sep_mask = vdupq_n_u8(SEP);
+    const uint8x16_t dot_mask = vdupq_n_u8('.');
+    for (; i + 16 < len; i += 16) {
+        uint8x16_t cur = vld1q_u8((const uint8_t *)(path + i));
+        uint8x16_t next = vld1q_u8((const uint8_t *)(path + i + 1));
+        uint8x16_t match = vandq_u8(vceqq_u8(cur, sep_mask), vorrq_u8(vceqq_u8(next, sep_mask), vceqq_u8(next, dot_mask)));
+        if (vmaxvq_u8(match)) {
+            return true;
+        }
+    }
+#else
+    // word-at-a-time search
+    typedef uintptr_t word_t;
+    const word_t ones = (word_t) -1 / 0xFF;
+    const word_t low_bits = ones * 0x7F;
+    const word_t sep_mask = ones * (unsigned char)SEP;
+    const word_t dot_mask = ones * (unsigned char)'.';
+    word_t cur, next;
+    for (; i + sizeof(word_t) < len; i += sizeof(word_t)) {
+        memcpy(&cur, path + i, sizeof(word_t));
+        memcpy(&next, path + i + 1, sizeof(word_t));
+        // set the highest bit of the bytes, that are equal to the mask bytes
+        cur ^= sep_mask;
+        cur = ~(((cur & low_bits) + low_bits) | cur | low_bits);
+        word_t next_sep = next ^ sep_mask;
+        word_t next_dot = next ^ dot_mask;
+        next_sep = ~(((next_sep & low_bits) + low_bits) | next_sep | low_bits);
+        next_dot = ~(((next_dot & low_bits) + low_bits) | next_dot | low_bits);
+        if (cur & (next_sep | next_dot)) {
+            return true;
+        }
+    }
+#endif
+    for (; i + 1 < len; i++) {
+        if (path[i] == SEP && (path[i + 1] == SEP || path[i + 1] == '.')) {
+            return true;
         }
     }
-
-    return ret_code;
+    return false;
 }
 
-int pathutil::append_path(char *path, const char *path_r)
+/**
+ * Check if path doesn't contain sequences, that may be non-normalized.
+ *
+ * @return true if path is normalized, false if it should be checked precisely
+ */
+static bool is_normalized_fast_impl(const char *path, size_t len)
 {
-    int ret_code = 0;
-    char *pos;
-
-    if (isabs(path_r) || path[0] == '\0') {
-        strcpy(path, path_r);
-    } else {
-        pos = path + strlen(path);
-        if (pos[-1] != SEP) {
-            pos[0] = SEP;
-            pos++;
-        }
-        strcpy(pos, path_r);
+    if (len <= 1) {
+        return true;
     }
+    return path[0] != '.' && path[len - 1] != SEP && !has_sep_sequence_impl(path, len);
+}
 
-    return ret_code;
+bool pathutil::is_normalized(const char *path)
+{
+    size_t len = strlen(path);
+    return is_normalized_fast_impl(path, len) || is_normalized_slow_impl(path, len);
 }
 
-int pathutil::normpath(char *path)
+/**
+ * Normalize path of the known length.
+ *
+ * @return length of the normalized path
+ */
+static size_t normpath_impl(char *path, size_t len)
 {
+    if (is_normalized_fast_impl(path, len)) {
+        // most of the paths are already normalized, so don't rewrite them
+        return len;
+    }
+
     char *pos = path - 1;
     bool stop_flag = false;
     bool abs_flag = false;
@@ -413,8 +2224,10 @@ int pathutil::normpath(char *path)
                     }
                     if (prev_sep < path) {
                         // "../" - nothing to collapse
+                        prev_sep = new_pos;
                     } else if ((prev_sep - prev_prev_sep) == 3 && prev_sep[-1] == '.' && prev_sep[-2] == '.') {
                         // "../../" - nothing to collapse
+                        prev_sep = new_pos;
                     } else {
                         // collapse "<some_path>/abc/../" to "<some_path>/"
                         prev_sep = prev_prev_sep;
@@ -433,102 +2246,549 @@ int pathutil::normpath(char *path)
         // path is reduced to empty path
         path[0] = '.';
         path[1] = '\0';
-    } else {
-        // remove trailing "/"
-        new_pos[-1] = '\0';
-        // process path collapse case
-        if (abs_flag && path[0] == '\0') {
-            path[0] = SEP;
-            path[1] = '\0';
-        }
+        return 1;
+    }
+    // remove trailing "/"
+    new_pos[-1] = '\0';
+    // process path collapse case
+    if (abs_flag && path[0] == '\0') {
+        path[0] = SEP;
+        path[1] = '\0';
+        return 1;
     }
+    return new_pos - 1 - path;
+}
 
+int pathutil::normpath(char *path)
+{
+    normpath_impl(path, strlen(path));
     return 0;
 }
 
-static int find_lsep(const char *path, const char *&lsep_pos)
+int pathutil::normpath_batch(char *buff, const size_t *offsets, size_t count, size_t *lengths)
 {
-    size_t path_len = strlen(path);
-    int i = (int)path_len - 1;
-    while (i >= 0 && path[i] != SEP) {
-        i--;
+    char *path;
+    size_t len;
+
+    for (size_t i = 0; i < count; i++) {
+        path = buff + offsets[i];
+        len = normpath_impl(path, strlen(path));
+        if (lengths != NULL) {
+            lengths[i] = len;
+        }
     }
-    lsep_pos = path + i;
     return 0;
 }
 
 int pathutil::basename(char *basename, size_t n, const char *path)
 {
-    const char *basename_start;
-    find_lsep(path, basename_start);
-    basename_start += 1;
-    size_t basename_len = strlen(basename_start);
-    if (basename_len > n) {
+    return PathView(path).filename().copy(basename, n);
+}
+
+int pathutil::basename(char *basename, const char *path)
+{
+    PathView name = PathView(path).filename();
+    return name.copy(basename, name.size() + 1);
+}
+
+int pathutil::dirname(char *path)
+{
+    path[PathView(path).parent().size()] = '\0';
+    return 0;
+}
+
+int pathutil::dirname(char *dirpath, size_t n, const char *path)
+{
+    return PathView(path).parent().copy(dirpath, n);
+}
+
+int pathutil::dirname(char *dirpath, const char *path)
+{
+    PathView parent = PathView(path).parent();
+    return parent.copy(dirpath, parent.size() + 1);
+}
+
+namespace {
+/**
+ * Iterator of the normalized path components in reverse order.
+ *
+ * It gives the same components as iteration of the normpath result, but doesn't modify the path:
+ * "." components are ignored and each ".." one skips a preceding component.
+ */
+class NormReverseIterator {
+public:
+    explicit NormReverseIterator(const PathView &path)
+        : _it(path.rbegin())
+        , _end(path.rend())
+        , _skip(0)
+        , _abs(path.is_absolute())
+    {
+    }
+
+    /**
+     * Get next component.
+     *
+     * @return false if there are no more components
+     */
+    bool next(PathView &part)
+    {
+        while (_it != _end) {
+            part = *_it;
+            ++_it;
+            if (part.size() == 1 && part.data()[0] == '.') {
+                continue;
+            } else if (part.size() == 2 && part.data()[0] == '.' && part.data()[1] == '.') {
+                _skip++;
+            } else if (_skip > 0) {
+                _skip--;
+            } else {
+                return true;
+            }
+        }
+        // ".." can't be collapsed at the beginning of the relative path, and it's ignored for absolute one
+        if (!_abs && _skip > 0) {
+            _skip--;
+            part = PathView("..", 2);
+            return true;
+        }
+        return false;
+    }
+
+    void skip(size_t num)
+    {
+        PathView part;
+        while (num > 0 && next(part)) {
+            num--;
+        }
+    }
+
+private:
+    PathView::ReverseIterator _it;
+    PathView::ReverseIterator _end;
+    size_t _skip;
+    bool _abs;
+};
+}
+
+static size_t count_norm_parts_impl(const PathView &path)
+{
+    NormReverseIterator it(path);
+    PathView part;
+    size_t num = 0;
+    while (it.next(part)) {
+        num++;
+    }
+    return num;
+}
+
+/**
+ * Get number of the common leading components of the normalized paths.
+ */
+static size_t count_common_parts_impl(const PathView &path_a, size_t parts_a, const PathView &path_b, size_t parts_b)
+{
+    NormReverseIterator it_a(path_a);
+    NormReverseIterator it_b(path_b);
+    PathView part_a;
+    PathView part_b;
+    size_t common = parts_a < parts_b ? parts_a : parts_b;
+    size_t i = common;
+
+    // align iterators and compare components from the end, so the last mismatch is the first one of the path
+    it_a.skip(parts_a - common);
+    it_b.skip(parts_b - common);
+    while (i > 0 && it_a.next(part_a) && it_b.next(part_b)) {
+        i--;
+        if (part_a.size() != part_b.size() || memcmp(part_a.data(), part_b.data(), part_a.size()) != 0) {
+            common = i;
+        }
+    }
+    return common;
+}
+
+/**
+ * Remove root separator and "." from normalized path, so it contains only components separated by single separators.
+ */
+static PathView strip_norm_path_impl(const PathView &path)
+{
+    if (path.is_absolute()) {
+        return PathView(path.data() + 1, path.size() - 1);
+    } else if (path.size() == 1 && path.data()[0] == '.') {
+        return PathView(path.data(), 0);
+    }
+    return path;
+}
+
+/**
+ * Get length of the common leading components of the stripped normalized paths.
+ */
+static size_t common_norm_prefix_impl(const PathView &path_a, const PathView &path_b)
+{
+    const char *a = path_a.data();
+    const char *b = path_b.data();
+    size_t len = path_a.size() < path_b.size() ? path_a.size() : path_b.size();
+    size_t i = 0;
+    uintptr_t word_a;
+    uintptr_t word_b;
+
+    // skip equal words, then find the first mismatch
+    while (i + sizeof(uintptr_t) <= len) {
+        memcpy(&word_a, a + i, sizeof(uintptr_t));
+        memcpy(&word_b, b + i, sizeof(uintptr_t));
+        if (word_a != word_b) {
+            break;
+        }
+        i += sizeof(uintptr_t);
+    }
+    while (i < len && a[i] == b[i]) {
+        i++;
+    }
+    if ((i == path_a.size() || a[i] == SEP) && (i == path_b.size() || b[i] == SEP)) {
+        return i;
+    }
+    // move to the beginning of the component
+    while (i > 0 && a[i - 1] != SEP) {
+        i--;
+    }
+    return i > 0 ? i - 1 : 0;
+}
+
+/**
+ * Get remaining part of the stripped normalized path after \p pos without leading separator.
+ */
+static PathView norm_path_tail_impl(const PathView &path, size_t pos)
+{
+    if (pos < path.size() && path.data()[pos] == SEP) {
+        pos++;
+    }
+    return PathView(path.data() + pos, path.size() - pos);
+}
+
+/**
+ * relpath implementation for normalized paths, that compares them directly in one pass.
+ */
+static int relpath_norm_impl(char *output_path, size_t n, const PathView &path, const PathView &start)
+{
+    PathView path_stripped = strip_norm_path_impl(path);
+    PathView start_stripped = strip_norm_path_impl(start);
+    size_t common = common_norm_prefix_impl(path_stripped, start_stripped);
+    PathView path_tail = norm_path_tail_impl(path_stripped, common);
+    PathView start_tail = norm_path_tail_impl(start_stripped, common);
+    size_t ups = start_tail.empty() ? 0 : 1;
+    size_t out_len;
+    char *pos;
+
+    for (size_t i = 0; i < start_tail.size(); i++) {
+        ups += start_tail.data()[i] == SEP ? 1 : 0;
+    }
+    if (ups == 0 && path_tail.empty()) {
+        // paths are same
+        path_tail = PathView(".", 1);
+    }
+    out_len = ups * 3 + path_tail.size() - (ups > 0 && path_tail.empty() ? 1 : 0);
+    if (out_len + 1 > n) {
+        errno = ENOBUFS;
         return -1;
     }
-    strcpy(basename, basename_start);
+    pos = output_path;
+    for (size_t i = 0; i < ups; i++) {
+        pos[0] = '.';
+        pos[1] = '.';
+        pos[2] = SEP;
+        pos += 3;
+    }
+    memcpy(pos, path_tail.data(), path_tail.size());
+    output_path[out_len] = '\0';
     return 0;
 }
 
-int pathutil::basename(char *basename, const char *path)
+/**
+ * Prepend string to the output that is written from the end of the buffer.
+ */
+static bool prepend_impl(char *output_path, size_t &pos, const char *data, size_t len, bool sep_flag)
+{
+    size_t total_len = len + (sep_flag ? 1 : 0);
+    if (total_len > pos) {
+        return false;
+    }
+    pos -= total_len;
+    memcpy(output_path + pos, data, len);
+    if (sep_flag) {
+        output_path[pos + len] = SEP;
+    }
+    return true;
+}
+
+/**
+ * Move output, that is written from the end of the buffer, to its beginning.
+ */
+static int finish_prepend_impl(char *output_path, size_t n, size_t pos, bool ok_flag)
 {
-    const char *basename_start;
-    find_lsep(path, basename_start);
-    basename_start += 1;
-    strcpy(basename, basename_start);
+    if (!ok_flag) {
+        errno = ENOBUFS;
+        return -1;
+    }
+    memmove(output_path, output_path + pos, n - pos);
     return 0;
 }
 
-int dirname_impl(char *dirpath, int n, const char *path)
+int pathutil::relpath(char *output_path, size_t n, const char *path, const char *start)
 {
-    int err;
-    const char *sep_start;
-    find_lsep(path, sep_start);
-    // remove multiple separators
-    while (sep_start > path && *(sep_start - 1) == SEP) {
-        sep_start--;
+    PathView path_view(path);
+    PathView start_view(start);
+    size_t path_parts;
+    size_t start_parts;
+    size_t common;
+    size_t pos = n - 1;
+    bool ok_flag = true;
+    bool sep_flag = false;
+    NormReverseIterator it(path_view);
+    PathView part;
+
+    if (n == 0) {
+        errno = ENOBUFS;
+        return -1;
+    }
+    if (path_view.empty() || start_view.empty() || path_view.is_absolute() != start_view.is_absolute()) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (is_normalized_fast_impl(path, path_view.size()) && is_normalized_fast_impl(start, start_view.size())) {
+        return relpath_norm_impl(output_path, n, path_view, start_view);
     }
 
-    int sep_start_i = sep_start - path;
-    if (sep_start_i < 0) {
-        // empty base path
-        dirpath[0] = '\0';
-        err = 0;
-    } else if (sep_start_i == 0) {
-        // dirname should be "/"
-        if (n >= 0 && n < 1) {
-            err = -1;
-        } else {
-            strcpy(dirpath, "/");
-            err = 0;
+    path_parts = count_norm_parts_impl(path_view);
+    start_parts = count_norm_parts_impl(start_view);
+    common = count_common_parts_impl(path_view, path_parts, start_view, start_parts);
+    if (common < start_parts) {
+        // check first start component after common prefix. If it's "..", the result depends on current directory
+        NormReverseIterator start_it(start_view);
+        start_it.skip(start_parts - common - 1);
+        if (start_it.next(part) && part.equals("..")) {
+            errno = EINVAL;
+            return -1;
         }
-    } else {
-        if (n >= 0 && sep_start_i > n) {
-            err = -1;
-        } else {
-            if (path != dirpath) {
-                strncpy(dirpath, path, (size_t)sep_start_i);
-            }
-            dirpath[sep_start_i] = '\0';
-            err = 0;
+    }
+
+    output_path[pos] = '\0';
+    for (size_t i = common; ok_flag && i < path_parts && it.next(part); i++) {
+        ok_flag = prepend_impl(output_path, pos, part.data(), part.size(), sep_flag);
+        sep_flag = true;
+    }
+    for (size_t i = common; ok_flag && i < start_parts; i++) {
+        ok_flag = prepend_impl(output_path, pos, "..", 2, sep_flag);
+        sep_flag = true;
+    }
+    if (ok_flag && !sep_flag) {
+        // paths are same
+        ok_flag = prepend_impl(output_path, pos, ".", 1, false);
+    }
+    return finish_prepend_impl(output_path, n, pos, ok_flag);
+}
+
+/**
+ * Get length of the common prefix of the paths, if all of them are normalized.
+ *
+ * @return false if some path isn't normalized
+ */
+static bool commonpath_norm_impl(const char *const *paths, size_t count, size_t &common_len)
+{
+    PathView first_stripped = strip_norm_path_impl(PathView(paths[0]));
+
+    if (!is_normalized_fast_impl(paths[0], strlen(paths[0]))) {
+        return false;
+    }
+    common_len = first_stripped.size();
+    for (size_t i = 1; i < count; i++) {
+        PathView path_view(paths[i]);
+        if (!is_normalized_fast_impl(path_view.data(), path_view.size())) {
+            return false;
         }
+        common_len = common_norm_prefix_impl(PathView(first_stripped.data(), common_len), strip_norm_path_impl(path_view));
     }
-    return err;
+    return true;
 }
 
-int pathutil::dirname(char *path)
+int pathutil::commonpath(char *output_path, size_t n, const char *const *paths, size_t count)
 {
-    return dirname_impl(path, -1, path);
+    PathView first_view;
+    size_t first_parts;
+    size_t common;
+    size_t pos = n - 1;
+    bool ok_flag = true;
+    bool sep_flag = false;
+    PathView part;
+
+    if (n == 0) {
+        errno = ENOBUFS;
+        return -1;
+    }
+    if (count == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    first_view = PathView(paths[0]);
+    for (size_t i = 1; i < count; i++) {
+        if (isabs(paths[i]) != first_view.is_absolute()) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+
+    if (commonpath_norm_impl(paths, count, common)) {
+        // copy common prefix of the first path with root separator
+        common += first_view.is_absolute() ? 1 : 0;
+        if (common + 1 > n) {
+            errno = ENOBUFS;
+            return -1;
+        }
+        memcpy(output_path, first_view.data(), common);
+        output_path[common] = '\0';
+        return 0;
+    }
+
+    first_parts = count_norm_parts_impl(first_view);
+    common = first_parts;
+    for (size_t i = 1; i < count && common > 0; i++) {
+        PathView path_view(paths[i]);
+        size_t path_common = count_common_parts_impl(first_view, first_parts, path_view, count_norm_parts_impl(path_view));
+        common = path_common < common ? path_common : common;
+    }
+
+    NormReverseIterator it(first_view);
+    it.skip(first_parts - common);
+    output_path[pos] = '\0';
+    for (size_t i = 0; ok_flag && i < common && it.next(part); i++) {
+        ok_flag = prepend_impl(output_path, pos, part.data(), part.size(), sep_flag);
+        sep_flag = true;
+    }
+    if (ok_flag && first_view.is_absolute()) {
+        ok_flag = prepend_impl(output_path, pos, "/", 1, false);
+    }
+    return finish_prepend_impl(output_path, n, pos, ok_flag);
 }
 
-int pathutil::dirname(char *dirpath, size_t n, const char *path)
+// base of the polynomial path hash
+#define PATH_HASH_BASE 0x100000001B3ull
+
+/**
+ * Polynomial hash of the string, that is \c sum(s[i] * B^(len - 1 - i)), and \c B^len.
+ *
+ * Hashes of the string parts are combined as \c hash(x + y) = hash(x) * B^len(y) + hash(y), so the hash
+ * of the normalized path can be calculated from its components in any order.
+ */
+struct PathHashState {
+    uint64_t hash;
+    uint64_t pow;
+};
+
+static constexpr uint64_t path_hash_pow_impl(size_t n)
 {
-    return dirname_impl(dirpath, n, path);
+    return n == 0 ? 1 : path_hash_pow_impl(n - 1) * PATH_HASH_BASE;
 }
 
-int pathutil::dirname(char *dirpath, const char *path)
+static const uint64_t path_hash_powers[9] = {
+    path_hash_pow_impl(0), path_hash_pow_impl(1), path_hash_pow_impl(2), path_hash_pow_impl(3), path_hash_pow_impl(4),
+    path_hash_pow_impl(5), path_hash_pow_impl(6), path_hash_pow_impl(7), path_hash_pow_impl(8)
+};
+
+/**
+ * Calculate hash of the string.
+ *
+ * Eight bytes are processed per step as dot product with the base powers, so multiplications are independent
+ * and can be executed in parallel (or vectorized by compiler).
+ */
+static PathHashState hash_string_impl(const char *data, size_t len)
+{
+    const uint64_t *pows = path_hash_powers;
+    const uint8_t *pos = (const uint8_t *)data;
+    PathHashState state = {0, 1};
+    uint64_t block;
+
+    for (; len >= 8; len -= 8, pos += 8) {
+        block = pos[0] * pows[7] + pos[1] * pows[6] + pos[2] * pows[5] + pos[3] * pows[4]
+                + pos[4] * pows[3] + pos[5] * pows[2] + pos[6] * pows[1] + pos[7];
+        state.hash = state.hash * pows[8] + block;
+        state.pow *= pows[8];
+    }
+    for (size_t i = 0; i < len; i++) {
+        state.hash = state.hash * PATH_HASH_BASE + pos[i];
+    }
+    state.pow *= pows[len];
+    return state;
+}
+
+uint32_t pathutil::path_hash(const char *path)
+{
+    PathView path_view(path);
+    PathView part;
+    PathHashState state;
+    PathHashState part_state;
+    size_t parts_num = 0;
+
+    if (is_normalized_fast_impl(path, path_view.size())) {
+        state = hash_string_impl(path, path_view.size());
+    } else {
+        // hash normalized path, that is joined from the end
+        NormReverseIterator it(path_view);
+        state.hash = 0;
+        state.pow = 1;
+        while (it.next(part)) {
+            part_state = hash_string_impl(part.data(), part.size());
+            if (parts_num > 0) {
+                part_state.hash = part_state.hash * PATH_HASH_BASE + SEP;
+                part_state.pow *= PATH_HASH_BASE;
+            }
+            state.hash += part_state.hash * state.pow;
+            state.pow *= part_state.pow;
+            parts_num++;
+        }
+        if (path_view.is_absolute()) {
+            state.hash += (uint64_t)SEP * state.pow;
+        } else if (parts_num == 0) {
+            // path is reduced to "."
+            state.hash = '.';
+        }
+    }
+
+    // final mixing
+    state.hash ^= state.hash >> 33;
+    state.hash *= 0xFF51AFD7ED558CCDull;
+    state.hash ^= state.hash >> 33;
+    return (uint32_t)(state.hash ^ (state.hash >> 32));
+}
+
+bool pathutil::path_equal(const char *path_a, const char *path_b)
 {
-    return dirname_impl(dirpath, -1, path);
+    PathView view_a(path_a);
+    PathView view_b(path_b);
+    PathView part_a;
+    PathView part_b;
+    bool next_a;
+    bool next_b;
+
+    if (view_a.empty() || view_b.empty()) {
+        // normpath keeps empty path unchanged
+        return view_a.empty() && view_b.empty();
+    }
+    if (view_a.is_absolute() != view_b.is_absolute()) {
+        return false;
+    }
+    if (is_normalized_fast_impl(path_a, view_a.size()) && is_normalized_fast_impl(path_b, view_b.size())) {
+        return view_a.size() == view_b.size() && memcmp(path_a, path_b, view_a.size()) == 0;
+    }
+
+    NormReverseIterator it_a(view_a);
+    NormReverseIterator it_b(view_b);
+    while (true) {
+        next_a = it_a.next(part_a);
+        next_b = it_b.next(part_b);
+        if (!next_a || !next_b) {
+            return next_a == next_b;
+        }
+        if (part_a.size() != part_b.size() || memcmp(part_a.data(), part_b.data(), part_a.size()) != 0) {
+            return false;
+        }
+    }
 }
 
 bool pathutil::is_child_dirent(const char *name)
@@ -576,6 +2836,7 @@ int pathutil::write_data(const char *path, const uint8_t *data, size_t len)
     if (close_ret_code && !ret_code) {
         ret_code = close_ret_code;
     }
+    stat_cache_invalidate(path);
 
     if (ret_code && !errno) {
         errno = EIO;
@@ -584,45 +2845,63 @@ int pathutil::write_data(const char *path, const uint8_t *data, size_t len)
     return ret_code;
 }
 
+/**
+ * Read \p len bytes from file, continuing short reads.
+ *
+ * @return number of read bytes, that is less than \p len only at the end of file, or -1 on error
+ */
+static ssize_t read_full_impl(int file, uint8_t *data, size_t len)
+{
+    size_t total = 0;
+    ssize_t read_res;
+
+    while (total < len) {
+        read_res = read(file, data + total, len - total);
+        if (read_res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        } else if (read_res == 0) {
+            break;
+        }
+        total += read_res;
+    }
+    return total;
+}
+
 int pathutil::read_data(const char *path, uint8_t *data, size_t len)
 {
     int file;
     int ret_code = 0;
     int close_ret_code = 0;
-    off_t seek_res;
-    int read_size = 0;
-    int file_size = 0;
+    struct stat file_stat;
+    ssize_t read_size = 0;
+    size_t file_size = 0;
 
     if ((file = open(path, O_RB_FLAG)) < 0) {
         return -1;
     }
 
-    // get file size
-    seek_res = lseek(file, 0, SEEK_END);
-    if (seek_res < 0) {
-        ret_code = -1;
-    } else {
-        file_size = seek_res;
-        seek_res = lseek(file, 0, SEEK_SET);
-        if (seek_res < 0) {
-            ret_code = -1;
-        }
-    }
-    if (ret_code < 0) {
+    // get file size from the opened file, so it doesn't require seeking
+    if (fstat(file, &file_stat)) {
         close(file);
         if (!errno) {
             errno = EIO;
         }
-        return ret_code;
+        return -1;
     }
+    file_size = file_stat.st_size;
 
     // read data
-    if ((size_t)file_size > len) {
+    if (file_size > len) {
         ret_code = -1;
         errno = ENOBUFS;
     } else {
-        read_size = read(file, data, len);
-        if (read_size != file_size) {
+        read_size = read_full_impl(file, data, file_size);
+        if (read_size < 0) {
+            ret_code = -1;
+        } else if ((size_t)read_size != file_size) {
             ret_code = -1;
             errno = EIO;
         }
@@ -633,7 +2912,7 @@ int pathutil::read_data(const char *path, uint8_t *data, size_t len)
         ret_code = close_ret_code;
     }
 
-    return ret_code ? ret_code : read_size;
+    return ret_code ? ret_code : (int)read_size;
 }
 
 int pathutil::write_str(const char *path, const char *text)
@@ -650,3 +2929,131 @@ int pathutil::read_str(const char *path, char *text, size_t len)
     text[res] = '\0';
     return res;
 }
+
+FileReader::FileReader()
+    : _file(-1)
+    , _size(0)
+    , _pos(0)
+{
+}
+
+FileReader::~FileReader()
+{
+    close();
+}
+
+int FileReader::open(const char *path, off_t offset, off_t length)
+{
+    struct stat file_stat;
+    int error;
+
+    if (close()) {
+        return -1;
+    }
+    if (offset < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if ((_file = ::open(path, O_RB_FLAG)) < 0) {
+        return -1;
+    }
+    if (fstat(_file, &file_stat)) {
+        goto error;
+    }
+    // limit window by the file size
+    if (offset >= file_stat.st_size) {
+        _size = 0;
+    } else {
+        _size = file_stat.st_size - offset;
+        if (length >= 0 && length < _size) {
+            _size = length;
+        }
+    }
+    if (offset > 0 && _size > 0 && lseek(_file, offset, SEEK_SET) < 0) {
+        goto error;
+    }
+    _pos = 0;
+    return 0;
+
+error:
+    error = errno ? errno : EIO;
+    ::close(_file);
+    _file = -1;
+    errno = error;
+    return -1;
+}
+
+ssize_t FileReader::read(uint8_t *buf, size_t len)
+{
+    ssize_t read_size;
+
+    if (_file < 0) {
+        errno = EBADF;
+        return -1;
+    }
+    if ((off_t)len > _size - _pos) {
+        len = _size - _pos;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    read_size = read_full_impl(_file, buf, len);
+    if (read_size < 0) {
+        return -1;
+    } else if ((size_t)read_size != len) {
+        // file has been truncated after opening
+        errno = EIO;
+        return -1;
+    }
+    _pos += read_size;
+    return read_size;
+}
+
+int FileReader::close()
+{
+    int ret_code = 0;
+
+    if (_file >= 0) {
+        ret_code = ::close(_file);
+        _file = -1;
+    }
+    _size = 0;
+    _pos = 0;
+    return ret_code;
+}
+
+int pathutil::read_chunks(const char *path, uint8_t *buf, size_t buf_len, ReadChunkCallback callback, void *context,
+                          off_t offset, off_t length)
+{
+    FileReader reader;
+    ssize_t read_size;
+    off_t chunk_offset = 0;
+    int origin_errno = errno;
+    int ret_code = 0;
+    int error;
+
+    if (buf_len == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (reader.open(path, offset, length)) {
+        return -1;
+    }
+    while ((read_size = reader.read(buf, buf_len)) > 0) {
+        ret_code = callback(buf, read_size, chunk_offset, context);
+        if (ret_code) {
+            break;
+        }
+        chunk_offset += read_size;
+    }
+    if (read_size < 0) {
+        ret_code = -1;
+    }
+    // keep error of the reading or of the callback
+    error = errno;
+    if (reader.close() && ret_code == 0) {
+        return -1;
+    }
+    errno = ret_code ? error : origin_errno;
+    return ret_code < 0 ? -1 : ret_code;
+}
@@ -0,0 +1,309 @@
+/**
+ * Shell-style pattern matching of the file names and paths.
+ */
+#include "pathutil.h"
+
+using namespace pathutil;
+
+#define SEP '/'
+
+#define GLOB_NPOS ((size_t)-1)
+
+/**
+ * Check if character has special meaning in the pattern.
+ */
+static bool is_glob_special_impl(char c)
+{
+    return c == '*' || c == '?' || c == '[' || c == ']' || c == '\\';
+}
+
+/**
+ * Find end of the character class, that starts at \p pos.
+ *
+ * @return position after closing ']' or \c GLOB_NPOS if the class isn't terminated
+ */
+static size_t find_class_end_impl(const char *pattern, size_t len, size_t pos)
+{
+    pos++;
+    if (pos < len && (pattern[pos] == '!' || pattern[pos] == '^')) {
+        pos++;
+    }
+    // the first ']' is a class member
+    if (pos < len && pattern[pos] == ']') {
+        pos++;
+    }
+    while (pos < len && pattern[pos] != ']') {
+        if (pattern[pos] == '\\' && pos + 1 < len) {
+            pos++;
+        }
+        pos++;
+    }
+    return pos < len ? pos + 1 : GLOB_NPOS;
+}
+
+/**
+ * Check if character belongs to the class <tt>[...]</tt>, that is placed in [begin, end).
+ */
+static bool match_class_impl(const char *pattern, size_t begin, size_t end, char c)
+{
+    size_t pos = begin + 1;
+    bool negate = false;
+    bool found = false;
+    unsigned char first;
+    unsigned char last;
+
+    if (pattern[pos] == '!' || pattern[pos] == '^') {
+        negate = true;
+        pos++;
+    }
+    end--;
+    do {
+        if (pattern[pos] == '\\') {
+            pos++;
+        }
+        first = pattern[pos++];
+        last = first;
+        if (pos + 1 < end && pattern[pos] == '-') {
+            pos++;
+            if (pattern[pos] == '\\') {
+                pos++;
+            }
+            last = pattern[pos++];
+        }
+        if ((unsigned char)c >= first && (unsigned char)c <= last) {
+            found = true;
+        }
+    } while (pos < end);
+    return found != negate;
+}
+
+/**
+ * Check if \c "**" at \p pos is a whole path component.
+ */
+static bool is_double_star_impl(const char *pattern, size_t len, size_t pos)
+{
+    return pos + 1 < len && pattern[pos + 1] == '*' && (pos == 0 || pattern[pos - 1] == SEP) && (pos + 2 == len || pattern[pos + 2] == SEP);
+}
+
+/**
+ * Match one character of the name with a pattern element at \p pos.
+ *
+ * @return length of the pattern element or 0 if character doesn't match
+ */
+static size_t match_char_impl(const char *pattern, size_t len, size_t pos, char c)
+{
+    size_t end;
+
+    switch (pattern[pos]) {
+    case '?':
+        return c != SEP ? 1 : 0;
+    case '[':
+        end = find_class_end_impl(pattern, len, pos);
+        if (end == GLOB_NPOS) {
+            // unterminated class is a literal '['
+            return c == '[' ? 1 : 0;
+        }
+        return c != SEP && match_class_impl(pattern, pos, end, c) ? end - pos : 0;
+    case '\\':
+        return pattern[pos + 1] == c ? 2 : 0;
+    default:
+        return pattern[pos] == c ? 1 : 0;
+    }
+}
+
+GlobPattern::GlobPattern()
+    : _pattern(NULL)
+    , _len(0)
+    , _prefix_len(0)
+    , _suffix_len(0)
+    , _min_len(0)
+    , _kind(KIND_NONE)
+{
+}
+
+int GlobPattern::compile(const char *pattern)
+{
+    size_t len = strlen(pattern);
+    size_t stars = 0;
+    size_t min_len = 0;
+    size_t prefix_len = GLOB_NPOS;
+    size_t suffix_len = 0;
+    bool simple = true;
+    size_t end;
+
+    _kind = KIND_NONE;
+    for (size_t pos = 0; pos < len;) {
+        switch (pattern[pos]) {
+        case '*':
+            if (prefix_len == GLOB_NPOS) {
+                prefix_len = pos;
+            }
+            if (is_double_star_impl(pattern, len, pos)) {
+                simple = false;
+                // "**/" can match empty string
+                pos += pos + 2 < len ? 3 : 2;
+                continue;
+            }
+            // sequence of stars is the same as one star
+            while (pos < len && pattern[pos] == '*') {
+                pos++;
+            }
+            stars++;
+            continue;
+        case '\\':
+            if (pos + 1 == len) {
+                errno = EINVAL;
+                return -1;
+            }
+            end = pos + 2;
+            break;
+        case '[':
+            end = find_class_end_impl(pattern, len, pos);
+            end = end == GLOB_NPOS ? pos + 1 : end;
+            break;
+        case '?':
+            end = pos + 1;
+            break;
+        default:
+            min_len++;
+            pos++;
+            continue;
+        }
+        if (prefix_len == GLOB_NPOS) {
+            prefix_len = pos;
+        }
+        simple = false;
+        min_len++;
+        pos = end;
+    }
+
+    if (prefix_len == GLOB_NPOS) {
+        _kind = KIND_LITERAL;
+        prefix_len = len;
+    } else {
+        // literal characters at the end of the pattern, escaped ones are ignored for simplicity
+        while (suffix_len < len - prefix_len && !is_glob_special_impl(pattern[len - suffix_len - 1])
+                && (len - suffix_len < 2 || pattern[len - suffix_len - 2] != '\\')) {
+            suffix_len++;
+        }
+        if (suffix_len > 0 && pattern[len - suffix_len] == SEP && len - suffix_len >= 2 && is_double_star_impl(pattern, len, len - suffix_len - 2)) {
+            // separator of the "**/" isn't required
+            suffix_len--;
+        }
+        // stray ']' isn't included to the suffix, so check that suffix follows the star
+        _kind = simple && stars == 1 && pattern[len - suffix_len - 1] == '*' ? KIND_STAR : KIND_GENERAL;
+    }
+    _pattern = pattern;
+    _len = len;
+    _prefix_len = prefix_len;
+    _suffix_len = suffix_len;
+    _min_len = min_len;
+    return 0;
+}
+
+bool GlobPattern::match(const char *name, size_t len) const
+{
+    if (_kind == KIND_NONE || len < _min_len) {
+        return false;
+    }
+    if (_kind == KIND_LITERAL) {
+        return len == _len && memcmp(name, _pattern, len) == 0;
+    }
+    if (memcmp(name, _pattern, _prefix_len) != 0 || memcmp(name + len - _suffix_len, _pattern + _len - _suffix_len, _suffix_len) != 0) {
+        return false;
+    }
+    if (_kind == KIND_STAR) {
+        // a single '*' between the prefix and the suffix matches anything except separator
+        return memchr(name + _prefix_len, SEP, len - _prefix_len - _suffix_len) == NULL;
+    }
+    return match_general(name, len);
+}
+
+/**
+ * Backtracking matcher.
+ *
+ * A failed match is retried from the last '*' with one more character consumed by it. If '*' reaches a separator,
+ * the match is retried from the last "**" with one more component consumed by it. Earlier stars are never
+ * revisited, as their alternatives are covered by the later ones, so neither recursion nor memory is required.
+ */
+bool GlobPattern::match_general(const char *name, size_t len) const
+{
+    const char *pattern = _pattern;
+    size_t p_len = _len;
+    size_t p_pos = _prefix_len;
+    size_t n_pos = _prefix_len;
+    size_t star_p_pos = GLOB_NPOS;
+    size_t star_n_pos = 0;
+    size_t dstar_p_pos = GLOB_NPOS;
+    size_t dstar_n_pos = 0;
+    size_t elem_len;
+    const char *sep_pos;
+
+    while (true) {
+        if (p_pos < p_len) {
+            if (pattern[p_pos] == '*') {
+                if (is_double_star_impl(pattern, p_len, p_pos)) {
+                    p_pos += 2;
+                    if (p_pos == p_len) {
+                        return true;
+                    }
+                    // "**/" matches empty string or any path ending with separator
+                    p_pos++;
+                    dstar_p_pos = p_pos;
+                    dstar_n_pos = n_pos;
+                    star_p_pos = GLOB_NPOS;
+                    continue;
+                }
+                while (p_pos < p_len && pattern[p_pos] == '*') {
+                    p_pos++;
+                }
+                if (p_pos == p_len && dstar_p_pos == GLOB_NPOS) {
+                    return memchr(name + n_pos, SEP, len - n_pos) == NULL;
+                }
+                star_p_pos = p_pos;
+                star_n_pos = n_pos;
+                continue;
+            }
+            if (n_pos < len && (elem_len = match_char_impl(pattern, p_len, p_pos, name[n_pos])) > 0) {
+                p_pos += elem_len;
+                n_pos++;
+                continue;
+            }
+        } else if (n_pos == len) {
+            return true;
+        }
+
+        // mismatch
+        if (star_p_pos != GLOB_NPOS && star_n_pos < len && name[star_n_pos] != SEP) {
+            star_n_pos++;
+            p_pos = star_p_pos;
+            n_pos = star_n_pos;
+            continue;
+        }
+        if (dstar_p_pos == GLOB_NPOS) {
+            return false;
+        }
+        sep_pos = (const char *)memchr(name + dstar_n_pos, SEP, len - dstar_n_pos);
+        if (sep_pos == NULL) {
+            return false;
+        }
+        dstar_n_pos = sep_pos - name + 1;
+        star_p_pos = GLOB_NPOS;
+        p_pos = dstar_p_pos;
+        n_pos = dstar_n_pos;
+    }
+}
+
+bool pathutil::fnmatch(const char *pattern, const char *name)
+{
+    GlobPattern glob;
+    return glob.compile(pattern) == 0 && glob.match(name);
+}
+
+struct dirent *pathutil::readdir_match(DIR *dirp, const GlobPattern &pattern)
+{
+    struct dirent *dir_ent;
+    while ((dir_ent = readdir_child(dirp)) != NULL && !pattern.match(dir_ent->d_name)) {
+    };
+    return dir_ent;
+}
@@ -0,0 +1,165 @@
+/**
+ * Memory mapped files.
+ *
+ * Files are mapped by mmap on host builds. On mbed-os they are read to a dynamically allocated buffer.
+ */
+#include "pathutil.h"
+
+#if PATHUTIL_USE_MMAP
+#include <sys/mman.h>
+#endif
+
+using namespace pathutil;
+
+MappedFile::MappedFile()
+    : _data(NULL)
+    , _size(0)
+    , _open(false)
+    , _mapped(false)
+{
+}
+
+MappedFile::MappedFile(MappedFile &&other)
+    : _data(other._data)
+    , _size(other._size)
+    , _open(other._open)
+    , _mapped(other._mapped)
+{
+    other._data = NULL;
+    other._size = 0;
+    other._open = false;
+    other._mapped = false;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other)
+{
+    if (this != &other) {
+        close();
+        _data = other._data;
+        _size = other._size;
+        _open = other._open;
+        _mapped = other._mapped;
+        other._data = NULL;
+        other._size = 0;
+        other._open = false;
+        other._mapped = false;
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+int MappedFile::open(const char *path, MapAccess access)
+{
+    int file;
+    struct stat file_stat;
+    int origin_errno = errno;
+    int error;
+
+    if (close()) {
+        return -1;
+    }
+    if ((file = ::open(path, O_RB_FLAG)) < 0) {
+        return -1;
+    }
+    if (fstat(file, &file_stat)) {
+        error = errno ? errno : EIO;
+        ::close(file);
+        errno = error;
+        return -1;
+    }
+    if (S_ISDIR(file_stat.st_mode)) {
+        ::close(file);
+        errno = EISDIR;
+        return -1;
+    }
+    if ((uint64_t)file_stat.st_size > (size_t)-1) {
+        ::close(file);
+        errno = EFBIG;
+        return -1;
+    }
+    if (file_stat.st_size == 0) {
+        // empty files can't be mapped
+        ::close(file);
+        _open = true;
+        return 0;
+    }
+
+#if PATHUTIL_USE_MMAP
+    void *addr = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    // the mapping doesn't require the opened descriptor
+    ::close(file);
+    if (addr != MAP_FAILED) {
+        if (access != MAP_ACCESS_NORMAL) {
+            // it's only a hint, so its errors are ignored
+            madvise(addr, file_stat.st_size, access == MAP_ACCESS_SEQUENTIAL ? MADV_SEQUENTIAL : MADV_RANDOM);
+        }
+        _data = (uint8_t *)addr;
+        _size = file_stat.st_size;
+        _open = true;
+        _mapped = true;
+        errno = origin_errno;
+        return 0;
+    }
+    // file system doesn't support mapping, so file is read to a buffer
+#else
+    (void)access;
+    ::close(file);
+#endif
+    if (read_file(path, file_stat.st_size)) {
+        return -1;
+    }
+    errno = origin_errno;
+    return 0;
+}
+
+int MappedFile::read_file(const char *path, size_t size)
+{
+    // read_data result is limited by int, so FileReader is used to read files of any size
+    FileReader reader;
+    ssize_t read_size = -1;
+    int error;
+
+    _data = new uint8_t[size];
+    if (reader.open(path, 0, size) == 0) {
+        read_size = reader.read(_data, size);
+    }
+    if (read_size < 0 || (size_t)read_size != size) {
+        error = read_size < 0 && errno ? errno : EIO;
+        delete[] _data;
+        _data = NULL;
+        errno = error;
+        return -1;
+    }
+    _size = size;
+    _open = true;
+    return 0;
+}
+
+int MappedFile::close()
+{
+    int ret_code = 0;
+
+    if (_mapped) {
+#if PATHUTIL_USE_MMAP
+        ret_code = munmap(_data, _size);
+#endif
+    } else {
+        delete[] _data;
+    }
+    _data = NULL;
+    _size = 0;
+    _open = false;
+    _mapped = false;
+    return ret_code;
+}
+
+MappedFile pathutil::map_file(const char *path, MapAccess access)
+{
+    MappedFile file;
+    file.open(path, access);
+    return file;
+}
@@ -0,0 +1,554 @@
+/**
+ * Multithreaded functions of the pathutil library.
+ *
+ * They are based on C++11 threads, so they are available on host builds only.
+ */
+#include "pathutil.h"
+
+#if PATHUTIL_USE_THREADS
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <new>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+using namespace pathutil;
+
+#define SEP '/'
+
+namespace {
+
+/**
+ * Directory, whose content is processed by the workers.
+ */
+struct DirNode {
+    DirNode(const std::string &path, const std::shared_ptr<DirNode> &parent)
+        : path(path)
+        , parent(parent)
+        , pending(1)
+    {
+    }
+
+    std::string path;
+    std::shared_ptr<DirNode> parent;
+    // number of subdirectories, that aren't removed yet, plus one while the directory itself is being read.
+    // It's used by the remover only.
+    std::atomic<size_t> pending;
+};
+
+typedef std::shared_ptr<DirNode> DirNodePtr;
+
+/**
+ * Worker queue of the directories.
+ *
+ * The owner takes the latest directories from the back of the queue (depth-first order), but other workers
+ * steal the oldest ones from the front. The oldest directories are usually nearest to the root,
+ * so they contain the largest subtrees.
+ */
+class WorkQueue {
+public:
+    void push(const DirNodePtr &node)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _nodes.push_back(node);
+    }
+
+    bool pop(DirNodePtr &node)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_nodes.empty()) {
+            return false;
+        }
+        node = _nodes.back();
+        _nodes.pop_back();
+        return true;
+    }
+
+    bool steal(DirNodePtr &node)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_nodes.empty()) {
+            return false;
+        }
+        node = _nodes.front();
+        _nodes.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex _mutex;
+    std::deque<DirNodePtr> _nodes;
+};
+
+/**
+ * Work-stealing pool, that processes directories of a tree.
+ *
+ * Each task is a directory. A worker reads the directory and pushes its subdirectories to its queue,
+ * so other workers can take them.
+ */
+class DirPool {
+public:
+    DirPool(size_t nthreads)
+        : _nthreads(nthreads)
+        , _queues(new WorkQueue[nthreads])
+        , _active_tasks(0)
+        , _queued_tasks(0)
+        , _idle_workers(0)
+        , _failed(false)
+        , _error(0)
+    {
+    }
+
+    virtual ~DirPool()
+    {
+    }
+
+    /**
+     * Process directory tree.
+     *
+     * @return 0 on success, otherwise error code
+     */
+    int run(const char *path)
+    {
+        std::vector<std::thread> threads;
+
+        try {
+            _queues[0].push(std::make_shared<DirNode>(path, DirNodePtr()));
+        } catch (const std::bad_alloc &) {
+            return ENOMEM;
+        }
+        _active_tasks = 1;
+        _queued_tasks = 1;
+
+        // if a thread can't be created, process the tree with the already started ones.
+        // The queues of the missing workers stay empty, so no directory is lost.
+        try {
+            threads.reserve(_nthreads - 1);
+            for (size_t i = 1; i < _nthreads; i++) {
+                threads.push_back(std::thread(&DirPool::run_worker, this, i));
+            }
+        } catch (const std::system_error &) {
+        } catch (const std::bad_alloc &) {
+        }
+        run_worker(0);
+        for (size_t i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+        return _failed ? _error.load() : 0;
+    }
+
+protected:
+    /**
+     * Process directory.
+     *
+     * @param id worker index
+     * @param node directory
+     * @return 0 on success, otherwise non-zero value and \c errno is set
+     */
+    virtual int process_dir(size_t id, const DirNodePtr &node) = 0;
+
+    /**
+     * Add subdirectory of the \p parent to the worker queue.
+     *
+     * @return 0 on success, otherwise -1 and \c errno is set to \c ENOMEM
+     */
+    int push_dir(size_t id, const DirNodePtr &parent, const char *name)
+    {
+        // the task is counted before it becomes visible to other workers, so the pool cannot finish too early
+        parent->pending++;
+        _active_tasks++;
+        _queued_tasks++;
+        try {
+            std::string sub_path = parent->path;
+            sub_path += SEP;
+            sub_path += name;
+            _queues[id].push(std::make_shared<DirNode>(sub_path, parent));
+        } catch (const std::bad_alloc &) {
+            // the current task is still active, so the counters cannot drop to zero here
+            _queued_tasks--;
+            _active_tasks--;
+            parent->pending--;
+            errno = ENOMEM;
+            return -1;
+        }
+        if (_idle_workers.load() > 0) {
+            wake_workers(false);
+        }
+        return 0;
+    }
+
+    bool failed() const
+    {
+        return _failed;
+    }
+
+private:
+    void run_worker(size_t id)
+    {
+        DirNodePtr node;
+
+        while (!_failed && _active_tasks.load() > 0) {
+            if (!_queues[id].pop(node) && !steal(id, node)) {
+                wait_tasks();
+                continue;
+            }
+            _queued_tasks--;
+            errno = 0;
+            try {
+                if (process_dir(id, node)) {
+                    fail(errno ? errno : EIO);
+                }
+            } catch (const std::bad_alloc &) {
+                // the task is completed anyway, so other workers don't wait for it
+                fail(ENOMEM);
+            }
+            node.reset();
+            if (--_active_tasks == 0) {
+                wake_workers(true);
+            }
+        }
+    }
+
+    /**
+     * Block until other workers find new directories, the tree is processed or the pool fails.
+     */
+    void wait_tasks()
+    {
+        std::unique_lock<std::mutex> lock(_idle_mutex);
+        // the counter is updated before the check, so a worker, that pushes a directory after it,
+        // sees the idle worker and wakes it
+        _idle_workers++;
+        _idle_cv.wait(lock, [this]() {
+            return _failed || _active_tasks.load() == 0 || _queued_tasks.load() > 0;
+        });
+        _idle_workers--;
+    }
+
+    void wake_workers(bool all)
+    {
+        {
+            // the mutex guarantees, that a waiting worker has either blocked or not checked the condition yet
+            std::lock_guard<std::mutex> lock(_idle_mutex);
+        }
+        if (all) {
+            _idle_cv.notify_all();
+        } else {
+            _idle_cv.notify_one();
+        }
+    }
+
+    bool steal(size_t id, DirNodePtr &node)
+    {
+        for (size_t i = 1; i < _nthreads; i++) {
+            if (_queues[(id + i) % _nthreads].steal(node)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void fail(int error)
+    {
+        bool expected = false;
+        if (_failed.compare_exchange_strong(expected, true)) {
+            _error = error;
+            wake_workers(true);
+        }
+    }
+
+    size_t _nthreads;
+    std::unique_ptr<WorkQueue[]> _queues;
+    std::atomic<size_t> _active_tasks;
+    // number of directories in the queues. Idle workers wait until it becomes positive
+    std::atomic<size_t> _queued_tasks;
+    std::atomic<size_t> _idle_workers;
+    std::mutex _idle_mutex;
+    std::condition_variable _idle_cv;
+    std::atomic<bool> _failed;
+    std::atomic<int> _error;
+};
+
+/**
+ * Pool, that removes directory tree.
+ *
+ * A worker removes files of the directory. A directory is removed by the worker, that completes
+ * its last subdirectory.
+ */
+class ParallelRemover : public DirPool {
+public:
+    ParallelRemover(size_t nthreads)
+        : DirPool(nthreads)
+    {
+    }
+
+protected:
+    int process_dir(size_t id, const DirNodePtr &node)
+    {
+        DIR *dir;
+        struct dirent *dir_entity;
+        int ret_code = 0;
+        int de_type;
+        int dir_fd;
+
+        if ((dir = opendir(node->path.c_str())) == NULL) {
+            return -1;
+        }
+        dir_fd = dirfd(dir);
+
+        while (!ret_code && !failed()) {
+            errno = 0;
+            if ((dir_entity = readdir(dir)) == NULL) {
+                ret_code = errno ? -1 : 0;
+                break;
+            }
+            if (!is_child_dirent(dir_entity->d_name)) {
+                continue;
+            }
+            de_type = dir_entity->d_type;
+            if (de_type == DT_UNKNOWN) {
+                // some file systems don't provide entry type
+                struct stat entry_stat;
+                if (fstatat(dir_fd, dir_entity->d_name, &entry_stat, AT_SYMLINK_NOFOLLOW)) {
+                    ret_code = -1;
+                    break;
+                }
+                de_type = IFTODT(entry_stat.st_mode);
+            }
+
+            switch (de_type) {
+            case DT_DIR:
+                ret_code = push_dir(id, node, dir_entity->d_name);
+                break;
+            case DT_REG:
+            case DT_LNK:
+                ret_code = unlinkat(dir_fd, dir_entity->d_name, 0);
+                break;
+            default:
+                // unsupported type
+                errno = EPERM;
+                ret_code = -1;
+                break;
+            }
+        }
+
+        if (closedir(dir) && !ret_code) {
+            ret_code = -1;
+        }
+        if (ret_code || failed()) {
+            return ret_code;
+        }
+        return complete_dir(node);
+    }
+
+    /**
+     * Release reading reference of the directory and remove directories, that have no pending subdirectories.
+     */
+    int complete_dir(DirNodePtr node)
+    {
+        while (node && node->pending.fetch_sub(1) == 1) {
+            if (rmdir(node->path.c_str())) {
+                return -1;
+            }
+            node = node->parent;
+        }
+        return 0;
+    }
+};
+
+/**
+ * Pool, that calculates disk usage of a directory tree.
+ *
+ * Workers count entries of each directory locally and add them to the totals once per directory.
+ */
+class ParallelDiskUsage : public DirPool {
+public:
+    ParallelDiskUsage(size_t nthreads)
+        : DirPool(nthreads)
+        , bytes(0)
+        , files(0)
+        , dirs(0)
+    {
+    }
+
+    std::atomic<uint64_t> bytes;
+    std::atomic<size_t> files;
+    std::atomic<size_t> dirs;
+
+protected:
+    int process_dir(size_t id, const DirNodePtr &node)
+    {
+        DIR *dir;
+        struct dirent *dir_entity;
+        struct stat entry_stat;
+        int ret_code = 0;
+        int dir_fd;
+        uint64_t dir_bytes = 0;
+        size_t dir_files = 0;
+        size_t dir_dirs = 0;
+
+        if ((dir = opendir(node->path.c_str())) == NULL) {
+            return -1;
+        }
+        dir_fd = dirfd(dir);
+
+        while (!ret_code && !failed()) {
+            errno = 0;
+            if ((dir_entity = readdir(dir)) == NULL) {
+                ret_code = errno ? -1 : 0;
+                break;
+            }
+            if (!is_child_dirent(dir_entity->d_name)) {
+                continue;
+            }
+            if (dir_entity->d_type != DT_DIR) {
+                // files require stat call anyway, so it also resolves unknown types
+                if (fstatat(dir_fd, dir_entity->d_name, &entry_stat, AT_SYMLINK_NOFOLLOW)) {
+                    ret_code = -1;
+                    break;
+                }
+                if (!S_ISDIR(entry_stat.st_mode)) {
+                    dir_bytes += entry_stat.st_size;
+                    dir_files++;
+                    continue;
+                }
+            }
+            dir_dirs++;
+            if (push_dir(id, node, dir_entity->d_name)) {
+                ret_code = -1;
+                break;
+            }
+        }
+
+        if (closedir(dir) && !ret_code) {
+            ret_code = -1;
+        }
+        bytes += dir_bytes;
+        files += dir_files;
+        dirs += dir_dirs;
+        return ret_code;
+    }
+};
+}
+
+int pathutil::rmtree_parallel(const char *path, size_t nthreads)
+{
+    int origin_errno = errno;
+    int error;
+
+    if (nthreads == 0) {
+        nthreads = std::thread::hardware_concurrency();
+        if (nthreads == 0) {
+            nthreads = 1;
+        }
+    }
+
+    stat_cache_invalidate(path);
+    try {
+        ParallelRemover remover(nthreads);
+        error = remover.run(path);
+    } catch (const std::bad_alloc &) {
+        // worker queues cannot be allocated
+        error = ENOMEM;
+    }
+    stat_cache_invalidate(path);
+    if (error != 0) {
+        errno = error;
+        return -1;
+    }
+    errno = origin_errno;
+    return 0;
+}
+
+int pathutil::disk_usage_parallel(const char *path, uint64_t *bytes, size_t *files, size_t *dirs, size_t nthreads)
+{
+    int origin_errno = errno;
+    int error;
+
+    if (nthreads == 0) {
+        nthreads = std::thread::hardware_concurrency();
+        if (nthreads == 0) {
+            nthreads = 1;
+        }
+    }
+
+    try {
+        ParallelDiskUsage usage(nthreads);
+        error = usage.run(path);
+        if (error == 0) {
+            if (bytes != NULL) {
+                *bytes = usage.bytes;
+            }
+            if (files != NULL) {
+                *files = usage.files;
+            }
+            if (dirs != NULL) {
+                *dirs = usage.dirs;
+            }
+        }
+    } catch (const std::bad_alloc &) {
+        // worker queues cannot be allocated
+        error = ENOMEM;
+    }
+    if (error != 0) {
+        errno = error;
+        return -1;
+    }
+    errno = origin_errno;
+    return 0;
+}
+
+// number of paths, that are taken by a thread at once
+#define NORMPATH_BATCH_CHUNK_SIZE 1024
+
+int pathutil::normpath_batch_parallel(char *buff, const size_t *offsets, size_t count, size_t *lengths, size_t nthreads)
+{
+    std::atomic<size_t> next_chunk(0);
+    std::vector<std::thread> threads;
+    size_t chunks_num = (count + NORMPATH_BATCH_CHUNK_SIZE - 1) / NORMPATH_BATCH_CHUNK_SIZE;
+
+    if (nthreads == 0) {
+        nthreads = std::thread::hardware_concurrency();
+        if (nthreads == 0) {
+            nthreads = 1;
+        }
+    }
+    if (nthreads > chunks_num) {
+        nthreads = chunks_num;
+    }
+    if (nthreads <= 1) {
+        return normpath_batch(buff, offsets, count, lengths);
+    }
+
+    auto worker = [&]() {
+        size_t chunk;
+        size_t start;
+        while ((chunk = next_chunk.fetch_add(1)) < chunks_num) {
+            start = chunk * NORMPATH_BATCH_CHUNK_SIZE;
+            normpath_batch(buff, offsets + start, std::min<size_t>(NORMPATH_BATCH_CHUNK_SIZE, count - start),
+                           lengths != NULL ? lengths + start : NULL);
+        }
+    };
+    threads.reserve(nthreads - 1);
+    for (size_t i = 1; i < nthreads; i++) {
+        // chunks are taken dynamically, so the current thread finishes the work if other ones can't be created
+        try {
+            threads.emplace_back(worker);
+        } catch (const std::system_error &) {
+            break;
+        }
+    }
+    worker();
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads[i].join();
+    }
+    return 0;
+}
+
+#endif // PATHUTIL_USE_THREADS
@@ -0,0 +1,274 @@
+/**
+ * Cache of the stat results.
+ */
+#include "pathutil.h"
+
+using namespace pathutil;
+
+#define SEP '/'
+
+// number of adjacent slots, where an entry can be placed
+#define STAT_CACHE_PROBE_LIMIT 4
+
+namespace {
+
+struct StatCacheEntry {
+    bool used;
+    uint32_t hash;
+    // entry creation time in microseconds. The 64-bit ticker is used, as the 32-bit one wraps around
+    // in about 71 minutes, so old entries could look fresh again.
+    us_timestamp_t timestamp;
+    // errno of the failed stat call or 0
+    int error;
+    mode_t mode;
+    off_t size;
+    time_t mtime;
+    char path[PATHUTIL_STAT_CACHE_PATH_MAX];
+};
+
+struct StatCache {
+    StatCacheEntry *entries;
+    size_t mask;
+    size_t probe_limit;
+    us_timestamp_t ttl_us;
+    // it's incremented by each invalidation to prevent caching of results, that have been got before it
+    uint32_t generation;
+    StatCacheStats stats;
+};
+
+SingletonPtr<PlatformMutex> cache_mutex;
+StatCache cache = {NULL, 0, 0, 0, 0, {0, 0}};
+// it duplicates cache.entries != NULL check, but can be read without the mutex,
+// so the disabled cache doesn't add key building and locking to each stat call
+volatile bool cache_enabled = false;
+}
+
+/**
+ * Copy and normalize path to the key buffer.
+ *
+ * @return true on success, false if path is too long
+ */
+static bool make_key_impl(const char *path, char *key)
+{
+    size_t path_len = strlen(path);
+    if (path_len + 1 > PATHUTIL_STAT_CACHE_PATH_MAX) {
+        return false;
+    }
+    memcpy(key, path, path_len + 1);
+    normpath(key);
+    return true;
+}
+
+static uint32_t hash_key_impl(const char *key)
+{
+    // FNV-1a hash
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *pos = (const unsigned char *)key; *pos != '\0'; pos++) {
+        hash ^= *pos;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Check if one of the paths is a parent of another one or they are same.
+ */
+static bool is_related_key_impl(const char *key_a, const char *key_b)
+{
+    size_t i = 0;
+    while (key_a[i] != '\0' && key_a[i] == key_b[i]) {
+        i++;
+    }
+    if (key_a[i] == '\0' && key_b[i] == '\0') {
+        return true;
+    } else if (key_a[i] == '\0') {
+        return key_b[i] == SEP || (i > 0 && key_a[i - 1] == SEP);
+    } else if (key_b[i] == '\0') {
+        return key_a[i] == SEP || (i > 0 && key_b[i - 1] == SEP);
+    } else {
+        return false;
+    }
+}
+
+static StatCacheEntry *find_entry_impl(const char *key, uint32_t hash)
+{
+    StatCacheEntry *entry;
+    for (size_t i = 0; i < cache.probe_limit; i++) {
+        entry = &cache.entries[(hash + i) & cache.mask];
+        if (entry->used && entry->hash == hash && strcmp(entry->path, key) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Find a free slot for the key or the oldest one of its bucket.
+ */
+static StatCacheEntry *allocate_entry_impl(uint32_t hash, us_timestamp_t now)
+{
+    StatCacheEntry *entry;
+    StatCacheEntry *oldest_entry = NULL;
+    for (size_t i = 0; i < cache.probe_limit; i++) {
+        entry = &cache.entries[(hash + i) & cache.mask];
+        if (!entry->used) {
+            return entry;
+        }
+        if (oldest_entry == NULL || now - entry->timestamp > now - oldest_entry->timestamp) {
+            oldest_entry = entry;
+        }
+    }
+    return oldest_entry;
+}
+
+int pathutil::stat_cache_enable(size_t capacity, uint32_t ttl_ms)
+{
+    size_t table_size = 1;
+    StatCacheEntry *entries;
+
+    if (capacity == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    while (table_size < capacity) {
+        table_size <<= 1;
+    }
+    entries = new StatCacheEntry[table_size];
+    memset(entries, 0, sizeof(StatCacheEntry) * table_size);
+
+    cache_mutex->lock();
+    delete[] cache.entries;
+    cache.entries = entries;
+    cache.mask = table_size - 1;
+    cache.probe_limit = table_size < STAT_CACHE_PROBE_LIMIT ? table_size : STAT_CACHE_PROBE_LIMIT;
+    cache.ttl_us = (us_timestamp_t)ttl_ms * 1000;
+    cache.generation++;
+    cache.stats.hits = 0;
+    cache.stats.misses = 0;
+    core_util_atomic_store_bool(&cache_enabled, true);
+    cache_mutex->unlock();
+    return 0;
+}
+
+void pathutil::stat_cache_disable()
+{
+    cache_mutex->lock();
+    delete[] cache.entries;
+    cache.entries = NULL;
+    cache.mask = 0;
+    cache.probe_limit = 0;
+    cache.generation++;
+    core_util_atomic_store_bool(&cache_enabled, false);
+    cache_mutex->unlock();
+}
+
+void pathutil::stat_cache_invalidate(const char *path)
+{
+    char key[PATHUTIL_STAT_CACHE_PATH_MAX];
+    bool key_flag;
+
+    if (!core_util_atomic_load_bool(&cache_enabled)) {
+        return;
+    }
+    cache_mutex->lock();
+    if (cache.entries != NULL) {
+        key_flag = path != NULL && make_key_impl(path, key);
+        cache.generation++;
+        // the table is small, so simple scan is used to find children and parents of the path
+        for (size_t i = 0; i <= cache.mask; i++) {
+            StatCacheEntry *entry = &cache.entries[i];
+            if (entry->used && (!key_flag || is_related_key_impl(entry->path, key))) {
+                entry->used = false;
+            }
+        }
+    }
+    cache_mutex->unlock();
+}
+
+void pathutil::stat_cache_get_stats(StatCacheStats *stats, bool reset)
+{
+    cache_mutex->lock();
+    *stats = cache.stats;
+    if (reset) {
+        cache.stats.hits = 0;
+        cache.stats.misses = 0;
+    }
+    cache_mutex->unlock();
+}
+
+int pathutil::stat_cached(const char *path, struct stat *buf)
+{
+    char key[PATHUTIL_STAT_CACHE_PATH_MAX];
+    uint32_t hash;
+    us_timestamp_t now;
+    uint32_t generation;
+    StatCacheEntry *entry;
+    int ret_code;
+    int error;
+
+    if (!core_util_atomic_load_bool(&cache_enabled) || !make_key_impl(path, key)) {
+        return stat(path, buf);
+    }
+    hash = hash_key_impl(key);
+
+    cache_mutex->lock();
+    if (cache.entries == NULL) {
+        cache_mutex->unlock();
+        return stat(path, buf);
+    }
+    now = ticker_read_us(get_us_ticker_data());
+    entry = find_entry_impl(key, hash);
+    if (entry != NULL && cache.ttl_us != 0 && now - entry->timestamp >= cache.ttl_us) {
+        entry->used = false;
+        entry = NULL;
+    }
+    if (entry != NULL) {
+        cache.stats.hits++;
+        error = entry->error;
+        if (!error) {
+            memset(buf, 0, sizeof(struct stat));
+            buf->st_mode = entry->mode;
+            buf->st_size = entry->size;
+            buf->st_mtime = entry->mtime;
+        }
+        cache_mutex->unlock();
+        if (error) {
+            errno = error;
+            return -1;
+        }
+        return 0;
+    }
+    cache.stats.misses++;
+    generation = cache.generation;
+    cache_mutex->unlock();
+
+    ret_code = stat(path, buf);
+    error = ret_code ? errno : 0;
+    if (error && error != ENOENT && error != ENOTDIR) {
+        // don't cache unexpected errors
+        return ret_code;
+    }
+
+    cache_mutex->lock();
+    if (cache.entries != NULL && cache.generation == generation) {
+        now = ticker_read_us(get_us_ticker_data());
+        entry = find_entry_impl(key, hash);
+        if (entry == NULL) {
+            entry = allocate_entry_impl(hash, now);
+        }
+        entry->used = true;
+        entry->hash = hash;
+        entry->timestamp = now;
+        entry->error = error;
+        entry->mode = error ? 0 : buf->st_mode;
+        entry->size = error ? 0 : buf->st_size;
+        entry->mtime = error ? 0 : buf->st_mtime;
+        strcpy(entry->path, key);
+    }
+    cache_mutex->unlock();
+
+    if (error) {
+        errno = error;
+    }
+    return ret_code;
+}
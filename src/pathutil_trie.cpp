@@ -0,0 +1,405 @@
+/**
+ * Compact storage of the paths in a prefix tree.
+ */
+#include "pathutil.h"
+
+using namespace pathutil;
+
+#define SEP '/'
+
+// identifier of the missing node
+#define NODE_NONE ((PathTrie::NodeId)0xFFFFFFFF)
+// node is a stored path, not only a parent of other paths
+#define NODE_FLAG_PATH 0x01
+// maximal length of the path component
+#define NODE_NAME_MAX 255
+
+struct PathTrie::Node {
+    NodeId parent;
+    NodeId first_child;
+    NodeId next_sibling;
+    uint16_t hash;
+    uint8_t name_len;
+    uint8_t flags;
+
+    // the name isn't null terminated and it's placed right after the node
+    const char *name() const
+    {
+        return (const char *)(this + 1);
+    }
+};
+
+namespace {
+bool is_dot_impl(const PathView &part)
+{
+    return part.size() == 1 && part.data()[0] == '.';
+}
+
+bool is_dotdot_impl(const PathView &part)
+{
+    return part.size() == 2 && part.data()[0] == '.' && part.data()[1] == '.';
+}
+
+/**
+ * Iterator of the normalized path components in forward order.
+ *
+ * It gives the same components as iteration of the normpath result. Components of the normalized path are
+ * simply iterated. Otherwise each component is checked, if it's removed by following "..", so the complexity
+ * is quadratic, but only for paths with ".." components.
+ */
+class NormForwardIterator {
+public:
+    explicit NormForwardIterator(const char *path)
+        : _view(path)
+        , _it(_view.begin())
+        , _end(_view.end())
+        , _lookahead(!is_normalized(path))
+        , _pending(0)
+    {
+    }
+
+    /**
+     * Get next component.
+     *
+     * @return false if there are no more components
+     */
+    bool next(PathView &part)
+    {
+        while (_it != _end) {
+            part = *_it;
+            ++_it;
+            if (is_dot_impl(part)) {
+                continue;
+            } else if (is_dotdot_impl(part)) {
+                if (_pending > 0) {
+                    // it removes one of the skipped components
+                    _pending--;
+                } else if (!_view.is_absolute()) {
+                    // ".." can't be collapsed at the beginning of the relative path
+                    return true;
+                }
+            } else if (_lookahead && is_removed()) {
+                _pending++;
+            } else {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    /**
+     * Check if current component is removed by following "..".
+     */
+    bool is_removed() const
+    {
+        size_t depth = 0;
+        PathView part;
+        for (PathView::Iterator it = _it; it != _end; ++it) {
+            part = *it;
+            if (is_dot_impl(part)) {
+                continue;
+            } else if (is_dotdot_impl(part)) {
+                if (depth == 0) {
+                    return true;
+                }
+                depth--;
+            } else {
+                depth++;
+            }
+        }
+        return false;
+    }
+
+    PathView _view;
+    PathView::Iterator _it;
+    PathView::Iterator _end;
+    bool _lookahead;
+    size_t _pending;
+};
+}
+
+static uint16_t hash_name_impl(const char *name, size_t len)
+{
+    // FNV-1a hash
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)name[i];
+        hash *= 16777619u;
+    }
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+
+void *PathArena::allocate(size_t size, size_t align)
+{
+    size_t padding = (size_t)(-(uintptr_t)(_buff + _used)) & (align - 1);
+    void *block;
+
+    if (padding + size > _size - _used) {
+        errno = ENOBUFS;
+        return NULL;
+    }
+    block = _buff + _used + padding;
+    _used += padding + size;
+    return block;
+}
+
+PathTrie::PathTrie(PathArena &arena)
+    : _arena(arena)
+    , _abs_root(NODE_NONE)
+    , _rel_root(NODE_NONE)
+    , _size(0)
+    , _node_count(0)
+    , _memory_used(0)
+{
+}
+
+PathTrie::Node *PathTrie::get_node(NodeId id) const
+{
+    return (Node *)(_arena.data() + id);
+}
+
+PathTrie::NodeId PathTrie::find_child(NodeId parent, const char *name, size_t len, uint16_t hash) const
+{
+    NodeId id = get_node(parent)->first_child;
+    Node *node;
+
+    while (id != NODE_NONE) {
+        node = get_node(id);
+        if (node->hash == hash && node->name_len == len && memcmp(node->name(), name, len) == 0) {
+            return id;
+        }
+        id = node->next_sibling;
+    }
+    return NODE_NONE;
+}
+
+PathTrie::NodeId PathTrie::add_node(NodeId parent, const char *name, size_t len, uint16_t hash)
+{
+    size_t used = _arena.used();
+    Node *node = (Node *)_arena.allocate(sizeof(Node) + len, sizeof(NodeId));
+    NodeId id;
+
+    if (node == NULL) {
+        return NODE_NONE;
+    }
+    id = (NodeId)((uint8_t *)node - _arena.data());
+    node->parent = parent;
+    node->first_child = NODE_NONE;
+    node->hash = hash;
+    node->name_len = (uint8_t)len;
+    node->flags = 0;
+    memcpy((char *)node->name(), name, len);
+    if (parent != NODE_NONE) {
+        // new children are added to the beginning of the list
+        node->next_sibling = get_node(parent)->first_child;
+        get_node(parent)->first_child = id;
+    } else {
+        node->next_sibling = NODE_NONE;
+    }
+    _memory_used += _arena.used() - used;
+    _node_count++;
+    return id;
+}
+
+PathTrie::NodeId PathTrie::find_node(const char *path) const
+{
+    NodeId id = isabs(path) ? _abs_root : _rel_root;
+    NormForwardIterator it(path);
+    PathView part;
+
+    while (id != NODE_NONE && it.next(part)) {
+        id = find_child(id, part.data(), part.size(), hash_name_impl(part.data(), part.size()));
+    }
+    return id;
+}
+
+int PathTrie::insert(const char *path, NodeId *id)
+{
+    NodeId *root;
+    NodeId node_id;
+    NodeId child_id;
+    NormForwardIterator it(path);
+    PathView part;
+    uint16_t hash;
+
+    if (path[0] == '\0') {
+        errno = EINVAL;
+        return -1;
+    }
+    root = isabs(path) ? &_abs_root : &_rel_root;
+    if (*root == NODE_NONE) {
+        *root = add_node(NODE_NONE, "", 0, 0);
+        if (*root == NODE_NONE) {
+            return -1;
+        }
+    }
+
+    node_id = *root;
+    while (it.next(part)) {
+        if (part.size() > NODE_NAME_MAX) {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        hash = hash_name_impl(part.data(), part.size());
+        child_id = find_child(node_id, part.data(), part.size(), hash);
+        if (child_id == NODE_NONE) {
+            child_id = add_node(node_id, part.data(), part.size(), hash);
+            if (child_id == NODE_NONE) {
+                return -1;
+            }
+        }
+        node_id = child_id;
+    }
+
+    Node *node = get_node(node_id);
+    if (!(node->flags & NODE_FLAG_PATH)) {
+        node->flags |= NODE_FLAG_PATH;
+        _size++;
+    }
+    if (id != NULL) {
+        *id = node_id;
+    }
+    return 0;
+}
+
+int PathTrie::lookup(const char *path, NodeId *id) const
+{
+    NodeId node_id = path[0] == '\0' ? NODE_NONE : find_node(path);
+
+    if (node_id == NODE_NONE || !(get_node(node_id)->flags & NODE_FLAG_PATH)) {
+        errno = ENOENT;
+        return -1;
+    }
+    if (id != NULL) {
+        *id = node_id;
+    }
+    return 0;
+}
+
+int PathTrie::get_path(NodeId id, char *buff, size_t n) const
+{
+    NodeId node_id = id;
+    Node *node;
+    size_t parts_num = 0;
+    size_t len = 0;
+
+    // calculate path length
+    for (node = get_node(node_id); node->parent != NODE_NONE; node_id = node->parent, node = get_node(node_id)) {
+        len += node->name_len;
+        parts_num++;
+    }
+    if (parts_num == 0) {
+        // root of the absolute or relative paths
+        len = 1;
+    } else {
+        len += parts_num - 1 + (node_id == _abs_root ? 1 : 0);
+    }
+    if (len + 1 > n) {
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    buff[len] = '\0';
+    if (parts_num == 0) {
+        buff[0] = node_id == _abs_root ? SEP : '.';
+        return 0;
+    }
+    // fill path from the end
+    for (node = get_node(id); node->parent != NODE_NONE; node = get_node(node->parent)) {
+        len -= node->name_len;
+        memcpy(buff + len, node->name(), node->name_len);
+        if (len > 0) {
+            buff[--len] = SEP;
+        }
+    }
+    return 0;
+}
+
+int PathTrie::enumerate(const char *prefix, char *buff, size_t n, Callback callback, void *context) const
+{
+    NodeId start_id = prefix[0] == '\0' ? NODE_NONE : find_node(prefix);
+    NodeId node_id;
+    Node *node;
+    size_t len;
+    int ret_code;
+
+    if (start_id == NODE_NONE) {
+        return 0;
+    }
+    if (get_path(start_id, buff, n)) {
+        return -1;
+    }
+    node = get_node(start_id);
+    if (node->flags & NODE_FLAG_PATH) {
+        ret_code = callback(buff, context);
+        if (ret_code) {
+            return ret_code;
+        }
+    }
+    if (start_id == _rel_root) {
+        // children of the relative root don't have "./" prefix
+        buff[0] = '\0';
+    }
+    len = strlen(buff);
+
+    // depth-first traversal using parent links
+    node_id = node->first_child;
+    while (node_id != NODE_NONE) {
+        node = get_node(node_id);
+        if (len > 0 && buff[len - 1] != SEP) {
+            if (len + 1 >= n) {
+                errno = ENOBUFS;
+                return -1;
+            }
+            buff[len++] = SEP;
+        }
+        if (len + node->name_len + 1 > n) {
+            errno = ENOBUFS;
+            return -1;
+        }
+        memcpy(buff + len, node->name(), node->name_len);
+        len += node->name_len;
+        buff[len] = '\0';
+
+        if (node->flags & NODE_FLAG_PATH) {
+            ret_code = callback(buff, context);
+            if (ret_code) {
+                return ret_code;
+            }
+        }
+        if (node->first_child != NODE_NONE) {
+            node_id = node->first_child;
+            continue;
+        }
+
+        // go to the next sibling of the node or of its nearest parent
+        while (true) {
+            len -= node->name_len;
+            if (len > 1 && buff[len - 1] == SEP) {
+                len--;
+            }
+            buff[len] = '\0';
+            if (node->next_sibling != NODE_NONE) {
+                node_id = node->next_sibling;
+                break;
+            }
+            node_id = node->parent;
+            if (node_id == start_id) {
+                node_id = NODE_NONE;
+                break;
+            }
+            node = get_node(node_id);
+        }
+    }
+    return 0;
+}
+
+void PathTrie::clear()
+{
+    _abs_root = NODE_NONE;
+    _rel_root = NODE_NONE;
+    _size = 0;
+    _node_count = 0;
+    _memory_used = 0;
+}